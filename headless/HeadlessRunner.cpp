@@ -0,0 +1,270 @@
+#include "dwgScenes.h"
+#include "dwgParallel.h"
+#include "dwgSimpleGraphics.h"
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// steps a scene without any window as fast as possible, prints steps per second and timings of the solver phases
+//
+//	headless-runner [cloth|chain] [--steps N] [--chains N] [--particles N] [--threads N] [--jacobi] [--deterministic]
+//		[--still N] [--render] [--capture PATH] [--width N] [--height N] [--impostors]
+//
+// --chains and --particles set the size of every cloth of the cloth scene, --threads 0 = one per hardware thread
+// --still keeps the kinematic colliders at their start for the first N steps, the cloths settle and fall asleep,
+// then the colliders start swinging and wake them up (the sleep counts are printed at the end)
+// --render draws every step with the software renderer (no GPU needed), --capture also writes the frames,
+// PATH is a printf format of the frame index, e.g. frame_%05d.png, a .raw extension writes headerless rgba8 frames,
+// --impostors draws the spheres as impostors
+
+// the same primitives as ClothSimulation, constrains as lines, particles and colliders as spheres, static shapes as lines
+static void dwgDrawScene(const ParticleSolver& solver, int32_t numConstrains)
+{
+	for (int32_t i = 0; i < numConstrains; ++i)
+	{
+		const ElasticDistance& c = solver.constrains[i];
+		if (!c.broken)
+			dwgDebugLine(solver.particles[c.idx_a].pos, solver.particles[c.idx_b].pos, { 1.f, 1.f, 1.f });
+	}
+
+	for (const Particle& particle : solver.particles)
+	{
+		dwgDebugSphere(particle.pos, Vector3(solver.particleRadius), particle.color);
+	}
+
+	for (const SphereCollider& col : solver.colliders)
+	{
+		dwgDebugSphere(col.pos, Vector3(col.radius), col.color);
+		dwgDebugLine(col.pos, col.pos + rotate(col.rotation, Vector3(0.f, 0.f, col.radius * 1.2f)), col.color);
+	}
+
+	for (const CapsuleCollider& capsule : solver.capsules)
+	{
+		dwgDebugCapsule(capsule.a, capsule.b, capsule.radius, capsule.color);
+	}
+
+	for (const BoxCollider& box : solver.boxes)
+	{
+		dwgDebugBox(box.pos, box.rotation, box.halfExtents, box.color);
+	}
+
+	for (const PlaneCollider& plane : solver.planes)
+	{
+		dwgDebugPlane(plane.normal, plane.offset, 16, { 0.4f, 0.4f, 0.4f });
+	}
+
+	for (const MeshCollider& mesh : solver.meshes)
+	{
+		for (size_t t = 0; t + 2 < mesh.indices.size(); t += 3)
+		{
+			const Vector3& a = mesh.vertices[mesh.indices[t + 0]];
+			const Vector3& b = mesh.vertices[mesh.indices[t + 1]];
+			const Vector3& c = mesh.vertices[mesh.indices[t + 2]];
+			dwgDebugLine(a, b, { 0.7f, 0.7f, 0.7f });
+			dwgDebugLine(b, c, { 0.7f, 0.7f, 0.7f });
+			dwgDebugLine(c, a, { 0.7f, 0.7f, 0.7f });
+		}
+	}
+}
+
+static void dwgPrintUsage()
+{
+	printf("usage: headless-runner [cloth|chain] [--steps N] [--chains N] [--particles N] [--threads N] [--jacobi] [--deterministic]\n");
+	printf("       [--still N] [--render] [--capture PATH] [--width N] [--height N] [--impostors]\n");
+}
+
+int main(int argc, char** argv)
+{
+	const char* scene = "cloth";
+	int32_t numSteps = 1000;
+	int32_t numChains = 8;
+	int32_t numParticles = 12;
+	int32_t numThreads = -1;
+	int32_t numStillSteps = 0;
+	bool jacobi = false;
+	bool deterministic = false;
+	bool render = false;
+	bool impostors = false;
+	const char* capturePath = nullptr;
+	int32_t width = 1600;
+	int32_t height = 900;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const bool hasValue = i + 1 < argc;
+
+		if (strcmp(argv[i], "--steps") == 0 && hasValue)
+			numSteps = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--chains") == 0 && hasValue)
+			numChains = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--particles") == 0 && hasValue)
+			numParticles = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--threads") == 0 && hasValue)
+			numThreads = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--jacobi") == 0)
+			jacobi = true;
+		else if (strcmp(argv[i], "--deterministic") == 0)
+			deterministic = true;
+		else if (strcmp(argv[i], "--still") == 0 && hasValue)
+			numStillSteps = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--render") == 0)
+			render = true;
+		else if (strcmp(argv[i], "--capture") == 0 && hasValue)
+		{
+			capturePath = argv[++i];
+			render = true;
+		}
+		else if (strcmp(argv[i], "--impostors") == 0)
+			impostors = true;
+		else if (strcmp(argv[i], "--width") == 0 && hasValue)
+			width = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--height") == 0 && hasValue)
+			height = atoi(argv[++i]);
+		else if (argv[i][0] != '-')
+			scene = argv[i];
+		else
+		{
+			dwgPrintUsage();
+			return 1;
+		}
+	}
+
+	ParticleSolver solver;
+	int32_t numDrawnConstrains = 0;
+	if (strcmp(scene, "cloth") == 0)
+	{
+		numDrawnConstrains = dwgBuildClothScene(solver, numChains, numParticles);
+	}
+	else if (strcmp(scene, "chain") == 0)
+	{
+		dwgBuildChainScene(solver);
+		numDrawnConstrains = (int32_t)solver.constrains.size();
+	}
+	else
+	{
+		dwgPrintUsage();
+		return 1;
+	}
+
+	if (numThreads >= 0)
+	{
+		dwgParallelSetThreadCount(numThreads);
+	}
+
+	if (jacobi)
+	{
+		solver.mode = SolverMode::Jacobi;
+	}
+	solver.deterministic = deterministic;
+
+	if (render && !dwgInitApp(width, height, "headless-runner", DWG_APP_SOFTWARE))
+	{
+		printf("Error: can't init the renderer\n");
+		return 1;
+	}
+
+	dwgDebugSphereImpostors(impostors);
+
+	// the extension picks the format, png unless it is .raw
+	const size_t capturePathLength = capturePath ? strlen(capturePath) : 0;
+	const bool captureRaw = capturePathLength >= 4 && strcmp(capturePath + capturePathLength - 4, ".raw") == 0;
+	if (capturePath && !dwgStartCapture(capturePath, captureRaw ? CaptureFormat::Raw : CaptureFormat::Png))
+	{
+		printf("Error: can't capture to %s\n", capturePath);
+		return 1;
+	}
+
+	printf("scene %s, %d particles, %d constrains, %d islands, %d threads\n", scene, (int)solver.particles.size(), (int)solver.constrains.size(), (int)solver.islands.size(), (int)dwgParallelThreadCount());
+
+	// the same fixed step as the apps, every step is a frame of its own (for the iteration time budget)
+	const float fixedDeltaTime = 1.f / 60.f;
+
+	SolverStats sum;
+	double sumMaxError = 0.0;
+	int64_t sumCollisionTests = 0;
+	int64_t sumIslandIterations = 0;
+	int32_t numFallAsleep = 0;
+	int32_t numWakeUps = 0;
+	int32_t maxSleepingIslands = 0;
+	int32_t prevSleepingIslands = 0;
+	double renderSeconds = 0.0;
+
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	for (int32_t step = 0; step < numSteps; ++step)
+	{
+		// the animation starts after the still steps
+		const double time = step > numStillSteps ? (step - numStillSteps) * fixedDeltaTime : 0.0;
+		if (strcmp(scene, "cloth") == 0)
+			dwgAnimateClothScene(solver, time);
+		else
+			dwgAnimateChainScene(solver, time);
+
+		dwgSolverBeginFrame(solver);
+		dwgSolverStep(solver, fixedDeltaTime);
+
+		const SolverStats& stats = solver.stats;
+		sum.integrateTime += stats.integrateTime;
+		sum.constrainsTime += stats.constrainsTime;
+		sum.collisionTime += stats.collisionTime;
+		sum.velocityTime += stats.velocityTime;
+		sum.numIterations += stats.numIterations;
+		sumIslandIterations += stats.numIslandIterations;
+		sumCollisionTests += stats.numCollisionTests;
+		sumMaxError += stats.maxError;
+
+		// changes of the count, an island that falls asleep and wakes up in the same step is not seen
+		if (stats.numSleepingIslands > prevSleepingIslands)
+			numFallAsleep += stats.numSleepingIslands - prevSleepingIslands;
+		else
+			numWakeUps += prevSleepingIslands - stats.numSleepingIslands;
+		maxSleepingIslands = stats.numSleepingIslands > maxSleepingIslands ? stats.numSleepingIslands : maxSleepingIslands;
+		prevSleepingIslands = stats.numSleepingIslands;
+
+		if (render)
+		{
+			const std::chrono::steady_clock::time_point renderStart = std::chrono::steady_clock::now();
+			dwgDrawScene(solver, numDrawnConstrains);
+
+			// the camera of ClothSimulation
+			const Matrix4 camera = Matrix4::lookAt(Point3(4.0f, 4.0f, 1.0f), Point3(0.0f, 0.0f, 0.0f), Vector3(0.0f, 0.0f, 1.0f));
+			dwgRender(camera, 120.0f);
+
+			renderSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - renderStart).count();
+		}
+	}
+
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	const double steps = numSteps > 0 ? (double)numSteps : 1.0;
+
+	printf("%d steps in %.3f s, %.1f steps/s, %.3f ms/step\n", numSteps, seconds, numSteps / seconds, 1000.0 * seconds / steps);
+	printf("phases (ms/step): integrate %.3f, constrains %.3f, collision %.3f, velocity %.3f\n",
+		sum.integrateTime / steps, sum.constrainsTime / steps, sum.collisionTime / steps, sum.velocityTime / steps);
+	printf("per step: %.2f iterations, %.1f island iterations, %.0f collision tests, max error %.5f\n",
+		sum.numIterations / steps, sumIslandIterations / steps, sumCollisionTests / steps, sumMaxError / steps);
+	printf("at the end: %d sleeping islands, %d awake particles\n", solver.stats.numSleepingIslands, solver.stats.numAwakeParticles);
+	if (solver.sleeping)
+	{
+		printf("sleeping: %d islands fell asleep, %d woke up, %d sleeping at most\n", numFallAsleep, numWakeUps, maxSleepingIslands);
+	}
+
+	if (deterministic)
+	{
+		printf("state hash %016llx\n", (unsigned long long)solver.stats.stateHash);
+	}
+
+	if (render)
+	{
+		const DwGDebugStats& stats = dwgDebugStats();
+		printf("render %dx%d: %.3f ms/frame (in the steps/s above), %d lines, %d spheres, %lld sphere triangles, culled %d lines, %d spheres\n",
+			width, height, 1000.0 * renderSeconds / steps, stats.numLines, stats.numSpheres, (long long)stats.numSphereTriangles,
+			stats.numCulledLines, stats.numCulledSpheres);
+
+		// writes the frames that are still pending
+		dwgReleaseApp();
+	}
+
+	return 0;
+}
@@ -287,36 +287,36 @@ inline const Matrix3 Matrix3::identity()
 inline const Matrix3 Matrix3::rotationX(float radians)
 {
     float s, c;
-    s = std::sinf(radians);
-    c = std::cosf(radians);
+    s = sinf(radians);
+    c = cosf(radians);
     return Matrix3(Vector3::xAxis(), Vector3(0.0f, c, s), Vector3(0.0f, -s, c));
 }
 
 inline const Matrix3 Matrix3::rotationY(float radians)
 {
     float s, c;
-    s = std::sinf(radians);
-    c = std::cosf(radians);
+    s = sinf(radians);
+    c = cosf(radians);
     return Matrix3(Vector3(c, 0.0f, -s), Vector3::yAxis(), Vector3(s, 0.0f, c));
 }
 
 inline const Matrix3 Matrix3::rotationZ(float radians)
 {
     float s, c;
-    s = std::sinf(radians);
-    c = std::cosf(radians);
+    s = sinf(radians);
+    c = cosf(radians);
     return Matrix3(Vector3(c, s, 0.0f), Vector3(-s, c, 0.0f), Vector3::zAxis());
 }
 
 inline const Matrix3 Matrix3::rotationZYX(const Vector3 & radiansXYZ)
 {
     float sX, cX, sY, cY, sZ, cZ, tmp0, tmp1;
-    sX = std::sinf(radiansXYZ.getX());
-    cX = std::cosf(radiansXYZ.getX());
-    sY = std::sinf(radiansXYZ.getY());
-    cY = std::cosf(radiansXYZ.getY());
-    sZ = std::sinf(radiansXYZ.getZ());
-    cZ = std::cosf(radiansXYZ.getZ());
+    sX = sinf(radiansXYZ.getX());
+    cX = cosf(radiansXYZ.getX());
+    sY = sinf(radiansXYZ.getY());
+    cY = cosf(radiansXYZ.getY());
+    sZ = sinf(radiansXYZ.getZ());
+    cZ = cosf(radiansXYZ.getZ());
     tmp0 = (cZ * sY);
     tmp1 = (sZ * sY);
     return Matrix3(Vector3((cZ * cY), (sZ * cY), -sY),
@@ -327,8 +327,8 @@ inline const Matrix3 Matrix3::rotationZYX(const Vector3 & radiansXYZ)
 inline const Matrix3 Matrix3::rotation(float radians, const Vector3 & unitVec)
 {
     float x, y, z, s, c, oneMinusC, xy, yz, zx;
-    s = std::sinf(radians);
-    c = std::cosf(radians);
+    s = sinf(radians);
+    c = cosf(radians);
     x = unitVec.getX();
     y = unitVec.getY();
     z = unitVec.getZ();
@@ -829,8 +829,8 @@ inline const Vector3 Matrix4::getTranslation() const
 inline const Matrix4 Matrix4::rotationX(float radians)
 {
     float s, c;
-    s = std::sinf(radians);
-    c = std::cosf(radians);
+    s = sinf(radians);
+    c = cosf(radians);
     return Matrix4(Vector4::xAxis(),
                    Vector4(0.0f,  c, s, 0.0f),
                    Vector4(0.0f, -s, c, 0.0f),
@@ -840,8 +840,8 @@ inline const Matrix4 Matrix4::rotationX(float radians)
 inline const Matrix4 Matrix4::rotationY(float radians)
 {
     float s, c;
-    s = std::sinf(radians);
-    c = std::cosf(radians);
+    s = sinf(radians);
+    c = cosf(radians);
     return Matrix4(Vector4(c, 0.0f, -s, 0.0f),
                    Vector4::yAxis(),
                    Vector4(s, 0.0f, c, 0.0f),
@@ -851,8 +851,8 @@ inline const Matrix4 Matrix4::rotationY(float radians)
 inline const Matrix4 Matrix4::rotationZ(float radians)
 {
     float s, c;
-    s = std::sinf(radians);
-    c = std::cosf(radians);
+    s = sinf(radians);
+    c = cosf(radians);
     return Matrix4(Vector4( c, s, 0.0f, 0.0f),
                    Vector4(-s, c, 0.0f, 0.0f),
                    Vector4::zAxis(),
@@ -862,12 +862,12 @@ inline const Matrix4 Matrix4::rotationZ(float radians)
 inline const Matrix4 Matrix4::rotationZYX(const Vector3 & radiansXYZ)
 {
     float sX, cX, sY, cY, sZ, cZ, tmp0, tmp1;
-    sX = std::sinf(radiansXYZ.getX());
-    cX = std::cosf(radiansXYZ.getX());
-    sY = std::sinf(radiansXYZ.getY());
-    cY = std::cosf(radiansXYZ.getY());
-    sZ = std::sinf(radiansXYZ.getZ());
-    cZ = std::cosf(radiansXYZ.getZ());
+    sX = sinf(radiansXYZ.getX());
+    cX = cosf(radiansXYZ.getX());
+    sY = sinf(radiansXYZ.getY());
+    cY = cosf(radiansXYZ.getY());
+    sZ = sinf(radiansXYZ.getZ());
+    cZ = cosf(radiansXYZ.getZ());
     tmp0 = (cZ * sY);
     tmp1 = (sZ * sY);
     return Matrix4(Vector4((cZ * cY), (sZ * cY), -sY, 0.0f),
@@ -879,8 +879,8 @@ inline const Matrix4 Matrix4::rotationZYX(const Vector3 & radiansXYZ)
 inline const Matrix4 Matrix4::rotation(float radians, const Vector3 & unitVec)
 {
     float x, y, z, s, c, oneMinusC, xy, yz, zx;
-    s = std::sinf(radians);
-    c = std::cosf(radians);
+    s = sinf(radians);
+    c = cosf(radians);
     x = unitVec.getX();
     y = unitVec.getY();
     z = unitVec.getZ();
@@ -950,7 +950,7 @@ inline const Matrix4 Matrix4::perspective(float fovyRadians, float aspect, float
     static const float VECTORMATH_PI_OVER_2 = 1.570796327f;
 
     float f, rangeInv;
-    f = std::tanf(VECTORMATH_PI_OVER_2 - (0.5f * fovyRadians));
+    f = tanf(VECTORMATH_PI_OVER_2 - (0.5f * fovyRadians));
     rangeInv = (1.0f / (zNear - zFar));
     return Matrix4(Vector4((f / aspect), 0.0f, 0.0f, 0.0f),
                    Vector4(0.0f, f, 0.0f, 0.0f),
@@ -1261,8 +1261,8 @@ inline const Vector3 Transform3::getTranslation() const
 inline const Transform3 Transform3::rotationX(float radians)
 {
     float s, c;
-    s = std::sinf(radians);
-    c = std::cosf(radians);
+    s = sinf(radians);
+    c = cosf(radians);
     return Transform3(Vector3::xAxis(),
                       Vector3(0.0f,  c, s),
                       Vector3(0.0f, -s, c),
@@ -1272,8 +1272,8 @@ inline const Transform3 Transform3::rotationX(float radians)
 inline const Transform3 Transform3::rotationY(float radians)
 {
     float s, c;
-    s = std::sinf(radians);
-    c = std::cosf(radians);
+    s = sinf(radians);
+    c = cosf(radians);
     return Transform3(Vector3(c, 0.0f, -s),
                       Vector3::yAxis(),
                       Vector3(s, 0.0f, c),
@@ -1283,8 +1283,8 @@ inline const Transform3 Transform3::rotationY(float radians)
 inline const Transform3 Transform3::rotationZ(float radians)
 {
     float s, c;
-    s = std::sinf(radians);
-    c = std::cosf(radians);
+    s = sinf(radians);
+    c = cosf(radians);
     return Transform3(Vector3( c, s, 0.0f),
                       Vector3(-s, c, 0.0f),
                       Vector3::zAxis(),
@@ -1294,12 +1294,12 @@ inline const Transform3 Transform3::rotationZ(float radians)
 inline const Transform3 Transform3::rotationZYX(const Vector3 & radiansXYZ)
 {
     float sX, cX, sY, cY, sZ, cZ, tmp0, tmp1;
-    sX = std::sinf(radiansXYZ.getX());
-    cX = std::cosf(radiansXYZ.getX());
-    sY = std::sinf(radiansXYZ.getY());
-    cY = std::cosf(radiansXYZ.getY());
-    sZ = std::sinf(radiansXYZ.getZ());
-    cZ = std::cosf(radiansXYZ.getZ());
+    sX = sinf(radiansXYZ.getX());
+    cX = cosf(radiansXYZ.getX());
+    sY = sinf(radiansXYZ.getY());
+    cY = cosf(radiansXYZ.getY());
+    sZ = sinf(radiansXYZ.getZ());
+    cZ = cosf(radiansXYZ.getZ());
     tmp0 = (cZ * sY);
     tmp1 = (sZ * sY);
     return Transform3(Vector3((cZ * cY), (sZ * cY), -sY),
@@ -1422,7 +1422,7 @@ inline Quat::Quat(const Matrix3 & tfrm)
     }
 
     radicand = (((xx + yy) + zz) + 1.0f);
-    scale = (0.5f * (1.0f / std::sqrtf(radicand)));
+    scale = (0.5f * (1.0f / sqrtf(radicand)));
 
     tmpx = ((zy - yz) * scale);
     tmpy = ((xz - zx) * scale);
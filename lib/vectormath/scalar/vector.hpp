@@ -96,10 +96,10 @@ inline const Vector3 slerp(float t, const Vector3 & unitVec0, const Vector3 & un
     cosAngle = dot(unitVec0, unitVec1);
     if (cosAngle < VECTORMATH_SLERP_TOL)
     {
-        angle = std::acosf(cosAngle);
-        recipSinAngle = (1.0f / std::sinf(angle));
-        scale0 = (std::sinf(((1.0f - t) * angle)) * recipSinAngle);
-        scale1 = (std::sinf((t * angle)) * recipSinAngle);
+        angle = acosf(cosAngle);
+        recipSinAngle = (1.0f / sinf(angle));
+        scale0 = (sinf(((1.0f - t) * angle)) * recipSinAngle);
+        scale1 = (sinf((t * angle)) * recipSinAngle);
     }
     else
     {
@@ -274,30 +274,30 @@ inline const Vector3 recipPerElem(const Vector3 & vec)
 
 inline const Vector3 sqrtPerElem(const Vector3 & vec)
 {
-    return Vector3(std::sqrtf(vec.getX()),
-                   std::sqrtf(vec.getY()),
-                   std::sqrtf(vec.getZ()));
+    return Vector3(sqrtf(vec.getX()),
+                   sqrtf(vec.getY()),
+                   sqrtf(vec.getZ()));
 }
 
 inline const Vector3 rsqrtPerElem(const Vector3 & vec)
 {
-    return Vector3((1.0f / std::sqrtf(vec.getX())),
-                   (1.0f / std::sqrtf(vec.getY())),
-                   (1.0f / std::sqrtf(vec.getZ())));
+    return Vector3((1.0f / sqrtf(vec.getX())),
+                   (1.0f / sqrtf(vec.getY())),
+                   (1.0f / sqrtf(vec.getZ())));
 }
 
 inline const Vector3 absPerElem(const Vector3 & vec)
 {
-    return Vector3(std::fabsf(vec.getX()),
-                   std::fabsf(vec.getY()),
-                   std::fabsf(vec.getZ()));
+    return Vector3(fabsf(vec.getX()),
+                   fabsf(vec.getY()),
+                   fabsf(vec.getZ()));
 }
 
 inline const Vector3 copySignPerElem(const Vector3 & vec0, const Vector3 & vec1)
 {
-    return Vector3((vec1.getX() < 0.0f) ? -std::fabsf(vec0.getX()) : std::fabsf(vec0.getX()),
-                   (vec1.getY() < 0.0f) ? -std::fabsf(vec0.getY()) : std::fabsf(vec0.getY()),
-                   (vec1.getZ() < 0.0f) ? -std::fabsf(vec0.getZ()) : std::fabsf(vec0.getZ()));
+    return Vector3((vec1.getX() < 0.0f) ? -fabsf(vec0.getX()) : fabsf(vec0.getX()),
+                   (vec1.getY() < 0.0f) ? -fabsf(vec0.getY()) : fabsf(vec0.getY()),
+                   (vec1.getZ() < 0.0f) ? -fabsf(vec0.getZ()) : fabsf(vec0.getZ()));
 }
 
 inline const Vector3 maxPerElem(const Vector3 & vec0, const Vector3 & vec1)
@@ -358,14 +358,14 @@ inline float lengthSqr(const Vector3 & vec)
 
 inline float length(const Vector3 & vec)
 {
-    return std::sqrtf(lengthSqr(vec));
+    return sqrtf(lengthSqr(vec));
 }
 
 inline const Vector3 normalize(const Vector3 & vec)
 {
     float lenSqr, lenInv;
     lenSqr = lengthSqr(vec);
-    lenInv = (1.0f / std::sqrtf(lenSqr));
+    lenInv = (1.0f / sqrtf(lenSqr));
     return Vector3((vec.getX() * lenInv),
                    (vec.getY() * lenInv),
                    (vec.getZ() * lenInv));
@@ -488,10 +488,10 @@ inline const Vector4 slerp(float t, const Vector4 & unitVec0, const Vector4 & un
     cosAngle = dot(unitVec0, unitVec1);
     if (cosAngle < VECTORMATH_SLERP_TOL)
     {
-        angle = std::acosf(cosAngle);
-        recipSinAngle = (1.0f / std::sinf(angle));
-        scale0 = (std::sinf(((1.0f - t) * angle)) * recipSinAngle);
-        scale1 = (std::sinf((t * angle)) * recipSinAngle);
+        angle = acosf(cosAngle);
+        recipSinAngle = (1.0f / sinf(angle));
+        scale0 = (sinf(((1.0f - t) * angle)) * recipSinAngle);
+        scale1 = (sinf((t * angle)) * recipSinAngle);
     }
     else
     {
@@ -680,34 +680,34 @@ inline const Vector4 recipPerElem(const Vector4 & vec)
 
 inline const Vector4 sqrtPerElem(const Vector4 & vec)
 {
-    return Vector4(std::sqrtf(vec.getX()),
-                   std::sqrtf(vec.getY()),
-                   std::sqrtf(vec.getZ()),
-                   std::sqrtf(vec.getW()));
+    return Vector4(sqrtf(vec.getX()),
+                   sqrtf(vec.getY()),
+                   sqrtf(vec.getZ()),
+                   sqrtf(vec.getW()));
 }
 
 inline const Vector4 rsqrtPerElem(const Vector4 & vec)
 {
-    return Vector4((1.0f / std::sqrtf(vec.getX())),
-                   (1.0f / std::sqrtf(vec.getY())),
-                   (1.0f / std::sqrtf(vec.getZ())),
-                   (1.0f / std::sqrtf(vec.getW())));
+    return Vector4((1.0f / sqrtf(vec.getX())),
+                   (1.0f / sqrtf(vec.getY())),
+                   (1.0f / sqrtf(vec.getZ())),
+                   (1.0f / sqrtf(vec.getW())));
 }
 
 inline const Vector4 absPerElem(const Vector4 & vec)
 {
-    return Vector4(std::fabsf(vec.getX()),
-                   std::fabsf(vec.getY()),
-                   std::fabsf(vec.getZ()),
-                   std::fabsf(vec.getW()));
+    return Vector4(fabsf(vec.getX()),
+                   fabsf(vec.getY()),
+                   fabsf(vec.getZ()),
+                   fabsf(vec.getW()));
 }
 
 inline const Vector4 copySignPerElem(const Vector4 & vec0, const Vector4 & vec1)
 {
-    return Vector4((vec1.getX() < 0.0f) ? -std::fabsf(vec0.getX()) : std::fabsf(vec0.getX()),
-                   (vec1.getY() < 0.0f) ? -std::fabsf(vec0.getY()) : std::fabsf(vec0.getY()),
-                   (vec1.getZ() < 0.0f) ? -std::fabsf(vec0.getZ()) : std::fabsf(vec0.getZ()),
-                   (vec1.getW() < 0.0f) ? -std::fabsf(vec0.getW()) : std::fabsf(vec0.getW()));
+    return Vector4((vec1.getX() < 0.0f) ? -fabsf(vec0.getX()) : fabsf(vec0.getX()),
+                   (vec1.getY() < 0.0f) ? -fabsf(vec0.getY()) : fabsf(vec0.getY()),
+                   (vec1.getZ() < 0.0f) ? -fabsf(vec0.getZ()) : fabsf(vec0.getZ()),
+                   (vec1.getW() < 0.0f) ? -fabsf(vec0.getW()) : fabsf(vec0.getW()));
 }
 
 inline const Vector4 maxPerElem(const Vector4 & vec0, const Vector4 & vec1)
@@ -775,14 +775,14 @@ inline float lengthSqr(const Vector4 & vec)
 
 inline float length(const Vector4 & vec)
 {
-    return std::sqrtf(lengthSqr(vec));
+    return sqrtf(lengthSqr(vec));
 }
 
 inline const Vector4 normalize(const Vector4 & vec)
 {
     float lenSqr, lenInv;
     lenSqr = lengthSqr(vec);
-    lenInv = (1.0f / std::sqrtf(lenSqr));
+    lenInv = (1.0f / sqrtf(lenSqr));
     return Vector4((vec.getX() * lenInv),
                    (vec.getY() * lenInv),
                    (vec.getZ() * lenInv),
@@ -971,30 +971,30 @@ inline const Point3 recipPerElem(const Point3 & pnt)
 
 inline const Point3 sqrtPerElem(const Point3 & pnt)
 {
-    return Point3(std::sqrtf(pnt.getX()),
-                  std::sqrtf(pnt.getY()),
-                  std::sqrtf(pnt.getZ()));
+    return Point3(sqrtf(pnt.getX()),
+                  sqrtf(pnt.getY()),
+                  sqrtf(pnt.getZ()));
 }
 
 inline const Point3 rsqrtPerElem(const Point3 & pnt)
 {
-    return Point3((1.0f / std::sqrtf(pnt.getX())),
-                  (1.0f / std::sqrtf(pnt.getY())),
-                  (1.0f / std::sqrtf(pnt.getZ())));
+    return Point3((1.0f / sqrtf(pnt.getX())),
+                  (1.0f / sqrtf(pnt.getY())),
+                  (1.0f / sqrtf(pnt.getZ())));
 }
 
 inline const Point3 absPerElem(const Point3 & pnt)
 {
-    return Point3(std::fabsf(pnt.getX()),
-                  std::fabsf(pnt.getY()),
-                  std::fabsf(pnt.getZ()));
+    return Point3(fabsf(pnt.getX()),
+                  fabsf(pnt.getY()),
+                  fabsf(pnt.getZ()));
 }
 
 inline const Point3 copySignPerElem(const Point3 & pnt0, const Point3 & pnt1)
 {
-    return Point3((pnt1.getX() < 0.0f) ? -std::fabsf(pnt0.getX()) : std::fabsf(pnt0.getX()),
-                  (pnt1.getY() < 0.0f) ? -std::fabsf(pnt0.getY()) : std::fabsf(pnt0.getY()),
-                  (pnt1.getZ() < 0.0f) ? -std::fabsf(pnt0.getZ()) : std::fabsf(pnt0.getZ()));
+    return Point3((pnt1.getX() < 0.0f) ? -fabsf(pnt0.getX()) : fabsf(pnt0.getX()),
+                  (pnt1.getY() < 0.0f) ? -fabsf(pnt0.getY()) : fabsf(pnt0.getY()),
+                  (pnt1.getZ() < 0.0f) ? -fabsf(pnt0.getZ()) : fabsf(pnt0.getZ()));
 }
 
 inline const Point3 maxPerElem(const Point3 & pnt0, const Point3 & pnt1)
@@ -0,0 +1,419 @@
+#include "dwgColliderShapes.h"
+#include "dwgParticleSolver.h"
+#include <math.h>
+#include <algorithm>
+
+// most triangles in a leaf of the mesh bvh
+#define DWG_BVH_LEAF_TRIANGLES 4
+
+// deepest bvh traversal
+#define DWG_BVH_STACK_SIZE 64
+
+#if VECTORMATH_MODE_SSE
+// positions of 4 particles as x, y, z registers
+static inline void dwgLoadPositions4(const Particle* particles, __m128& x, __m128& y, __m128& z)
+{
+	__m128 p0 = particles[0].pos.get128();
+	__m128 p1 = particles[1].pos.get128();
+	__m128 p2 = particles[2].pos.get128();
+	__m128 p3 = particles[3].pos.get128();
+	_MM_TRANSPOSE4_PS(p0, p1, p2, p3);
+
+	x = p0;
+	y = p1;
+	z = p2;
+}
+
+static inline __m128 dwgDot4(__m128 ax, __m128 ay, __m128 az, __m128 bx, __m128 by, __m128 bz)
+{
+	return _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(ay, by)), _mm_mul_ps(az, bz));
+}
+
+static inline __m128 dwgClamp4(__m128 x, __m128 low, __m128 high)
+{
+	return _mm_min_ps(_mm_max_ps(x, low), high);
+}
+#endif
+
+// runs the 4-wide test, and resolve() only for particles the test reported (remaining particles are resolved directly)
+// resolve() has to do the precise test itself, it's called for the tail and in scalar mode for every particle
+template<typename Test4, typename Resolve>
+static inline void dwgCollideBatch(Particle* particles, int32_t numParticles, Test4 test4, Resolve resolve)
+{
+	int32_t i = 0;
+
+#if VECTORMATH_MODE_SSE
+	for (; i + 4 <= numParticles; i += 4)
+	{
+		__m128 x, y, z;
+		dwgLoadPositions4(particles + i, x, y, z);
+
+		int mask = _mm_movemask_ps(test4(x, y, z));
+		while (mask)
+		{
+			const int32_t lane = mask & 1 ? 0 : mask & 2 ? 1 : mask & 4 ? 2 : 3;
+			mask &= ~(1 << lane);
+			resolve(particles[i + lane]);
+		}
+	}
+#endif
+
+	for (; i < numParticles; ++i)
+	{
+		resolve(particles[i]);
+	}
+}
+
+void dwgCollidePlane(const PlaneCollider& plane, Particle* particles, int32_t numParticles, float radius)
+{
+	const float limit = plane.offset + radius;
+
+#if VECTORMATH_MODE_SSE
+	const __m128 nx = _mm_set1_ps(plane.normal.getX());
+	const __m128 ny = _mm_set1_ps(plane.normal.getY());
+	const __m128 nz = _mm_set1_ps(plane.normal.getZ());
+	const __m128 limit4 = _mm_set1_ps(limit);
+#endif
+
+	dwgCollideBatch(particles, numParticles,
+#if VECTORMATH_MODE_SSE
+		[&](__m128 x, __m128 y, __m128 z) { return _mm_cmplt_ps(dwgDot4(x, y, z, nx, ny, nz), limit4); },
+#else
+		0,
+#endif
+		[&](Particle& p)
+		{
+			const float distance = dot(plane.normal, p.pos);
+			if (p.mass > 0.f && distance < limit)
+			{
+				p.pos += plane.normal * (limit - distance);
+			}
+		});
+}
+
+void dwgCollideCapsule(const CapsuleCollider& capsule, Particle* particles, int32_t numParticles, float radius)
+{
+	const Vector3 axis = capsule.b - capsule.a;
+	const float axisLengthSqr = lengthSqr(axis);
+	const float invAxisLengthSqr = axisLengthSqr > 0.f ? 1.f / axisLengthSqr : 0.f;
+	const float collisionDistance = capsule.radius + radius;
+
+#if VECTORMATH_MODE_SSE
+	const __m128 ax = _mm_set1_ps(capsule.a.getX());
+	const __m128 ay = _mm_set1_ps(capsule.a.getY());
+	const __m128 az = _mm_set1_ps(capsule.a.getZ());
+	const __m128 dx = _mm_set1_ps(axis.getX());
+	const __m128 dy = _mm_set1_ps(axis.getY());
+	const __m128 dz = _mm_set1_ps(axis.getZ());
+	const __m128 invLength4 = _mm_set1_ps(invAxisLengthSqr);
+	const __m128 limit4 = _mm_set1_ps(collisionDistance * collisionDistance);
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.f);
+#endif
+
+	dwgCollideBatch(particles, numParticles,
+#if VECTORMATH_MODE_SSE
+		[&](__m128 x, __m128 y, __m128 z)
+		{
+			// closest point on the segment
+			const __m128 rx = _mm_sub_ps(x, ax);
+			const __m128 ry = _mm_sub_ps(y, ay);
+			const __m128 rz = _mm_sub_ps(z, az);
+			const __m128 t = dwgClamp4(_mm_mul_ps(dwgDot4(rx, ry, rz, dx, dy, dz), invLength4), zero, one);
+
+			const __m128 ox = _mm_sub_ps(rx, _mm_mul_ps(dx, t));
+			const __m128 oy = _mm_sub_ps(ry, _mm_mul_ps(dy, t));
+			const __m128 oz = _mm_sub_ps(rz, _mm_mul_ps(dz, t));
+			return _mm_cmplt_ps(dwgDot4(ox, oy, oz, ox, oy, oz), limit4);
+		},
+#else
+		0,
+#endif
+		[&](Particle& p)
+		{
+			if (p.mass <= 0.f)
+				return;
+
+			float t = dot(p.pos - capsule.a, axis) * invAxisLengthSqr;
+			t = t < 0.f ? 0.f : (t > 1.f ? 1.f : t);
+
+			const Vector3 offset = p.pos - (capsule.a + axis * t);
+			const float distance = length(offset);
+			if (distance < collisionDistance && distance > 0.f)
+			{
+				p.pos += offset * ((collisionDistance - distance) / distance);
+			}
+		});
+}
+
+void dwgCollideBox(const BoxCollider& box, Particle* particles, int32_t numParticles, float radius)
+{
+	const Matrix3 rotation(box.rotation);
+	const Vector3 axes[3] = { rotation.getCol0(), rotation.getCol1(), rotation.getCol2() };
+	const float halfExtents[3] = { box.halfExtents.getX(), box.halfExtents.getY(), box.halfExtents.getZ() };
+
+#if VECTORMATH_MODE_SSE
+	const __m128 cx = _mm_set1_ps(box.pos.getX());
+	const __m128 cy = _mm_set1_ps(box.pos.getY());
+	const __m128 cz = _mm_set1_ps(box.pos.getZ());
+	const __m128 limit4 = _mm_set1_ps(radius * radius);
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 signMask = _mm_set1_ps(-0.f);
+#endif
+
+	dwgCollideBatch(particles, numParticles,
+#if VECTORMATH_MODE_SSE
+		[&](__m128 x, __m128 y, __m128 z)
+		{
+			// distance from the box, 0 inside
+			const __m128 rx = _mm_sub_ps(x, cx);
+			const __m128 ry = _mm_sub_ps(y, cy);
+			const __m128 rz = _mm_sub_ps(z, cz);
+
+			__m128 distanceSqr = zero;
+			for (int32_t k = 0; k < 3; ++k)
+			{
+				const __m128 local = dwgDot4(rx, ry, rz, _mm_set1_ps(axes[k].getX()), _mm_set1_ps(axes[k].getY()), _mm_set1_ps(axes[k].getZ()));
+				const __m128 outside = _mm_max_ps(_mm_sub_ps(_mm_andnot_ps(signMask, local), _mm_set1_ps(halfExtents[k])), zero);
+				distanceSqr = _mm_add_ps(distanceSqr, _mm_mul_ps(outside, outside));
+			}
+			return _mm_cmplt_ps(distanceSqr, limit4);
+		},
+#else
+		0,
+#endif
+		[&](Particle& p)
+		{
+			if (p.mass <= 0.f)
+				return;
+
+			const Vector3 relative = p.pos - box.pos;
+			float local[3];
+			float closest[3];
+			bool inside = true;
+
+			for (int32_t k = 0; k < 3; ++k)
+			{
+				local[k] = dot(relative, axes[k]);
+				closest[k] = local[k] < -halfExtents[k] ? -halfExtents[k] : (local[k] > halfExtents[k] ? halfExtents[k] : local[k]);
+				inside = inside && closest[k] == local[k];
+			}
+
+			if (inside)
+			{
+				// out through the closest face
+				int32_t face = 0;
+				for (int32_t k = 1; k < 3; ++k)
+				{
+					if (halfExtents[k] - fabsf(local[k]) < halfExtents[face] - fabsf(local[face]))
+						face = k;
+				}
+
+				const float target = local[face] < 0.f ? -halfExtents[face] - radius : halfExtents[face] + radius;
+				p.pos += axes[face] * (target - local[face]);
+				return;
+			}
+
+			const Vector3 offset = p.pos - (box.pos + axes[0] * closest[0] + axes[1] * closest[1] + axes[2] * closest[2]);
+			const float distance = length(offset);
+			if (distance < radius && distance > 0.f)
+			{
+				p.pos += offset * ((radius - distance) / distance);
+			}
+		});
+}
+
+// closest point on triangle abc to point p (Ericson, Real-Time Collision Detection 5.1.5)
+static Vector3 dwgClosestPointOnTriangle(const Vector3& p, const Vector3& a, const Vector3& b, const Vector3& c)
+{
+	const Vector3 ab = b - a;
+	const Vector3 ac = c - a;
+
+	const Vector3 ap = p - a;
+	const float d1 = dot(ab, ap);
+	const float d2 = dot(ac, ap);
+	if (d1 <= 0.f && d2 <= 0.f)
+		return a;
+
+	const Vector3 bp = p - b;
+	const float d3 = dot(ab, bp);
+	const float d4 = dot(ac, bp);
+	if (d3 >= 0.f && d4 <= d3)
+		return b;
+
+	const float vc = d1 * d4 - d3 * d2;
+	if (vc <= 0.f && d1 >= 0.f && d3 <= 0.f)
+		return a + ab * (d1 / (d1 - d3));
+
+	const Vector3 cp = p - c;
+	const float d5 = dot(ab, cp);
+	const float d6 = dot(ac, cp);
+	if (d6 >= 0.f && d5 <= d6)
+		return c;
+
+	const float vb = d5 * d2 - d1 * d6;
+	if (vb <= 0.f && d2 >= 0.f && d6 <= 0.f)
+		return a + ac * (d2 / (d2 - d6));
+
+	const float va = d3 * d6 - d5 * d4;
+	if (va <= 0.f && (d4 - d3) >= 0.f && (d5 - d6) >= 0.f)
+		return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+
+	const float denom = 1.f / (va + vb + vc);
+	return a + ab * (vb * denom) + ac * (vc * denom);
+}
+
+static void dwgBuildBvhNode(MeshCollider& mesh, const std::vector<Vector3>& centers, int32_t nodeIndex, int32_t first, int32_t count)
+{
+	Vector3 low(1e30f);
+	Vector3 high(-1e30f);
+	for (int32_t i = first; i < first + count; ++i)
+	{
+		const int32_t* tri = &mesh.indices[3 * mesh.bvhTriangles[i]];
+		for (int32_t v = 0; v < 3; ++v)
+		{
+			low = minPerElem(low, mesh.vertices[tri[v]]);
+			high = maxPerElem(high, mesh.vertices[tri[v]]);
+		}
+	}
+
+	mesh.bvhNodes[nodeIndex].min = low;
+	mesh.bvhNodes[nodeIndex].max = high;
+
+	if (count <= DWG_BVH_LEAF_TRIANGLES)
+	{
+		mesh.bvhNodes[nodeIndex].first = first;
+		mesh.bvhNodes[nodeIndex].count = count;
+		return;
+	}
+
+	// split at the median of triangle centers along the longest axis
+	const Vector3 size = high - low;
+	const int32_t axis = size.getX() > size.getY() ? (size.getX() > size.getZ() ? 0 : 2) : (size.getY() > size.getZ() ? 1 : 2);
+	const int32_t half = count / 2;
+
+	std::nth_element(mesh.bvhTriangles.begin() + first, mesh.bvhTriangles.begin() + first + half, mesh.bvhTriangles.begin() + first + count,
+		[&](int32_t t0, int32_t t1) { return centers[t0][axis] < centers[t1][axis]; });
+
+	const int32_t left = (int32_t)mesh.bvhNodes.size();
+	mesh.bvhNodes.resize(left + 2);
+	mesh.bvhNodes[nodeIndex].first = left;
+	mesh.bvhNodes[nodeIndex].count = 0;
+
+	dwgBuildBvhNode(mesh, centers, left, first, half);
+	dwgBuildBvhNode(mesh, centers, left + 1, first + half, count - half);
+}
+
+void dwgBuildMeshCollider(MeshCollider& mesh)
+{
+	const int32_t numTriangles = (int32_t)mesh.indices.size() / 3;
+
+	std::vector<Vector3> centers(numTriangles);
+	mesh.bvhTriangles.resize(numTriangles);
+	for (int32_t i = 0; i < numTriangles; ++i)
+	{
+		const int32_t* tri = &mesh.indices[3 * i];
+		centers[i] = (mesh.vertices[tri[0]] + mesh.vertices[tri[1]] + mesh.vertices[tri[2]]) / 3.f;
+		mesh.bvhTriangles[i] = i;
+	}
+
+	mesh.bvhNodes.clear();
+	if (numTriangles == 0)
+		return;
+
+	mesh.bvhNodes.resize(1);
+	dwgBuildBvhNode(mesh, centers, 0, 0, numTriangles);
+}
+
+void dwgCollideMesh(const MeshCollider& mesh, Particle* particles, int32_t numParticles, float radius)
+{
+	if (mesh.bvhNodes.empty())
+		return;
+
+	const Vector3 extent(radius);
+	const Vector3 meshLow = mesh.bvhNodes[0].min - extent;
+	const Vector3 meshHigh = mesh.bvhNodes[0].max + extent;
+
+#if VECTORMATH_MODE_SSE
+	const __m128 lowX = _mm_set1_ps(meshLow.getX());
+	const __m128 lowY = _mm_set1_ps(meshLow.getY());
+	const __m128 lowZ = _mm_set1_ps(meshLow.getZ());
+	const __m128 highX = _mm_set1_ps(meshHigh.getX());
+	const __m128 highY = _mm_set1_ps(meshHigh.getY());
+	const __m128 highZ = _mm_set1_ps(meshHigh.getZ());
+#endif
+
+	// the batch test is the bounds of the whole mesh, the particles inside walk the BVH one by one
+	dwgCollideBatch(particles, numParticles,
+#if VECTORMATH_MODE_SSE
+		[&](__m128 x, __m128 y, __m128 z)
+		{
+			const __m128 insideX = _mm_and_ps(_mm_cmpge_ps(x, lowX), _mm_cmple_ps(x, highX));
+			const __m128 insideY = _mm_and_ps(_mm_cmpge_ps(y, lowY), _mm_cmple_ps(y, highY));
+			const __m128 insideZ = _mm_and_ps(_mm_cmpge_ps(z, lowZ), _mm_cmple_ps(z, highZ));
+			return _mm_and_ps(insideX, _mm_and_ps(insideY, insideZ));
+		},
+#else
+		0,
+#endif
+		[&](Particle& p)
+		{
+			if (p.mass <= 0.f)
+				return;
+
+			int32_t stack[DWG_BVH_STACK_SIZE];
+			int32_t stackSize = 0;
+			stack[stackSize++] = 0;
+
+			while (stackSize > 0)
+			{
+				const MeshBvhNode& node = mesh.bvhNodes[stack[--stackSize]];
+
+				// particle sphere bounds vs node bounds
+				const Vector3 low = p.pos - extent;
+				const Vector3 high = p.pos + extent;
+				if (low.getX() > node.max.getX() || low.getY() > node.max.getY() || low.getZ() > node.max.getZ() ||
+					high.getX() < node.min.getX() || high.getY() < node.min.getY() || high.getZ() < node.min.getZ())
+					continue;
+
+				if (node.count == 0)
+				{
+					if (stackSize + 2 <= DWG_BVH_STACK_SIZE)
+					{
+						stack[stackSize++] = node.first;
+						stack[stackSize++] = node.first + 1;
+					}
+					continue;
+				}
+
+				for (int32_t t = node.first; t < node.first + node.count; ++t)
+				{
+					const int32_t* tri = &mesh.indices[3 * mesh.bvhTriangles[t]];
+					const Vector3& a = mesh.vertices[tri[0]];
+					const Vector3& b = mesh.vertices[tri[1]];
+					const Vector3& c = mesh.vertices[tri[2]];
+
+					const Vector3 closest = dwgClosestPointOnTriangle(p.pos, a, b, c);
+					const Vector3 normal = normalize(cross(b - a, c - a));
+
+					// stay on the side the particle came from, even if it went through the triangle during the step
+					const float side = dot(p.prevPos - a, normal) < 0.f ? -1.f : 1.f;
+					const float height = dot(p.pos - a, normal) * side;
+
+					const Vector3 offset = p.pos - closest;
+					const float distance = length(offset);
+
+					// behind the plane of the triangle and above the triangle itself (closest point is the projection)
+					const Vector3 projected = p.pos - normal * (height * side);
+					if (height < 0.f && lengthSqr(closest - projected) < 1e-8f)
+					{
+						p.pos = closest + normal * (side * radius);
+					}
+					else if (distance < radius && distance > 0.f)
+					{
+						p.pos += offset * ((radius - distance) / distance);
+					}
+				}
+			}
+		});
+}
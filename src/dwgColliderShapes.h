@@ -0,0 +1,63 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include "vectormath.hpp"
+
+struct Particle;
+
+// static (or kinematic) collider shapes, they push particles out but particles don't push them
+// every shape tests 4 particles at once with SSE and resolves only the ones that overlap
+// the mesh tests them against its bounds, particles inside walk its BVH one by one
+
+// segment from a to b with a radius
+struct CapsuleCollider
+{
+	Vector3 a;
+	Vector3 b;
+	float radius = 0.5f;
+	Vector3 color;
+};
+
+// oriented box
+struct BoxCollider
+{
+	Vector3 pos;
+	Quat rotation = Quat::identity();
+	Vector3 halfExtents = Vector3(0.5f);
+	Vector3 color;
+};
+
+// infinite plane, points with dot(normal, point) < offset are inside
+struct PlaneCollider
+{
+	Vector3 normal = Vector3(0.f, 0.f, 1.f);
+	float offset = 0.f;
+};
+
+struct MeshBvhNode
+{
+	Vector3 min;
+	Vector3 max;
+	int32_t first = 0;	// leaf: first triangle in MeshCollider::bvhTriangles, inner node: index of the left child (right one is next)
+	int32_t count = 0;	// number of triangles of a leaf, 0 for inner nodes
+};
+
+// static triangle mesh (two sided), call dwgBuildMeshCollider after filling vertices and indices
+struct MeshCollider
+{
+	std::vector<Vector3> vertices;
+	std::vector<int32_t> indices;	// 3 per triangle
+
+	std::vector<MeshBvhNode> bvhNodes;
+	std::vector<int32_t> bvhTriangles;
+};
+
+// builds the bounding volume hierarchy of the mesh triangles
+void dwgBuildMeshCollider(MeshCollider& mesh);
+
+// pushes the particles out of the shape, particles have the same radius
+void dwgCollideCapsule(const CapsuleCollider& capsule, Particle* particles, int32_t numParticles, float radius);
+void dwgCollideBox(const BoxCollider& box, Particle* particles, int32_t numParticles, float radius);
+void dwgCollidePlane(const PlaneCollider& plane, Particle* particles, int32_t numParticles, float radius);
+void dwgCollideMesh(const MeshCollider& mesh, Particle* particles, int32_t numParticles, float radius);
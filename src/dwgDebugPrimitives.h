@@ -0,0 +1,36 @@
+#pragma once
+
+#include <stdint.h>
+
+// recorded debug primitives, shared by the OpenGL and the software renderer
+
+// vertex of debug lines and of the sphere mesh
+struct DebugVertex
+{
+	float x, y, z;
+	float r, g, b;
+};
+
+// 36 bytes per instance, the world transform is built in the vertex shader
+struct DebugSphere
+{
+	float position[3];
+	float scale[3];
+	int16_t rotation[4];	// normalized quaternion x, y, z, w as snorm16
+	uint8_t color[4];	// rgba8
+};
+
+// sphere meshes from the finest to the coarsest, selected per sphere by its projected radius
+#define DWG_SPHERE_LODS 4
+
+// spheres drawn as impostors follow the LODs, their mesh is a quad (see dwgDebugSphereImpostors)
+#define DWG_SPHERE_IMPOSTOR DWG_SPHERE_LODS
+
+// part of the shared sphere vertex and index buffers, indices are absolute (not relative to firstVertex)
+struct DebugSphereLod
+{
+	int32_t firstVertex;
+	int32_t numVertices;
+	int32_t firstIndex;
+	int32_t numIndices;
+};
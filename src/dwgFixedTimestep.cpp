@@ -0,0 +1,42 @@
+#include "dwgFixedTimestep.h"
+
+void dwgFixedTimestepBeginFrame(FixedTimestep& timestep, float dt)
+{
+	timestep.accumulatedTime += dt;
+	timestep.frameTime = dt;
+	timestep.frameDroppedTime = 0.f;
+	timestep.numSteps = 0;
+	timestep.frameStart = std::chrono::steady_clock::now();
+}
+
+bool dwgFixedTimestepNext(FixedTimestep& timestep)
+{
+	const float fixedDeltaTime = timestep.fixedDeltaTime;
+
+	if (timestep.accumulatedTime >= fixedDeltaTime)
+	{
+		bool overBudget = timestep.numSteps >= timestep.maxSteps;
+		if (timestep.maxStepTime > 0.f && timestep.numSteps > 0)
+		{
+			overBudget = overBudget || std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - timestep.frameStart).count() >= timestep.maxStepTime;
+		}
+
+		if (!overBudget)
+		{
+			timestep.accumulatedTime -= fixedDeltaTime;
+			timestep.numSteps += 1;
+			return true;
+		}
+
+		// drop whole steps, the fraction stays for the interpolation
+		const float dropped = fixedDeltaTime * (float)(int32_t)(timestep.accumulatedTime / fixedDeltaTime);
+		timestep.accumulatedTime -= dropped;
+		timestep.droppedTime += dropped;
+		timestep.frameDroppedTime += dropped;
+	}
+
+	timestep.alpha = timestep.accumulatedTime / fixedDeltaTime;
+	timestep.alpha = timestep.alpha < 0.f ? 0.f : (timestep.alpha > 1.f ? 1.f : timestep.alpha);
+	timestep.timeScale = timestep.frameTime > 0.f ? 1.f - timestep.frameDroppedTime / timestep.frameTime : 1.f;
+	return false;
+}
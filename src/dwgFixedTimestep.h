@@ -0,0 +1,38 @@
+#pragma once
+
+#include <stdint.h>
+#include <chrono>
+
+// fixed steps of the simulation in a variable frame rate
+//
+//	dwgFixedTimestepBeginFrame(timestep, dt);
+//	while (dwgFixedTimestepNext(timestep))
+//		dwgSolverStep(solver, timestep.fixedDeltaTime);
+//	dwgSolverInterpolate(solver, timestep.alpha, positions);
+//
+// a slow frame needs more steps, which makes the next frame even slower (spiral of death)
+// so the steps of a frame are limited by maxSteps and maxStepTime, the time that didn't fit is dropped
+// and the simulation runs slower than the real time until the frames are fast enough again (time dilation)
+struct FixedTimestep
+{
+	float fixedDeltaTime = 1.f / 60.f;
+	int32_t maxSteps = 4;		// most steps per frame
+	float maxStepTime = 0.f;	// most time of steps per frame in milliseconds (0 = no limit)
+
+	float accumulatedTime = 0.f;	// time that wasn't simulated yet, less than fixedDeltaTime after the steps
+	float alpha = 0.f;				// accumulatedTime / fixedDeltaTime, how far to interpolate from the previous to the last step
+	float timeScale = 1.f;			// simulated time / real time of the last frame, less than 1 when time was dropped
+	float droppedTime = 0.f;		// all the time that was dropped
+
+	// state of the current frame
+	float frameTime = 0.f;
+	float frameDroppedTime = 0.f;
+	int32_t numSteps = 0;
+	std::chrono::steady_clock::time_point frameStart;
+};
+
+// adds the time since the last frame
+void dwgFixedTimestepBeginFrame(FixedTimestep& timestep, float dt);
+
+// true if one more step should be done, updates alpha and timeScale after the last one
+bool dwgFixedTimestepNext(FixedTimestep& timestep);
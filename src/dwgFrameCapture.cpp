@@ -0,0 +1,360 @@
+#include "dwgFrameCapture.h"
+#include <stdio.h>
+#include <string.h>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct CapturedFrame
+{
+	int32_t index = 0;
+	int32_t width = 0;
+	int32_t height = 0;
+	std::vector<uint8_t> rgba;
+};
+
+struct DwGFrameCapture
+{
+	std::string pathFormat;
+	CaptureFormat format = CaptureFormat::Png;
+	int32_t maxPendingFrames = 4;
+
+	std::thread writer;
+	std::mutex mutex;
+	std::condition_variable pendingCondition;	// the writer waits here for frames
+	std::condition_variable writtenCondition;	// dwgCaptureFrame waits here when too many frames are pending
+
+	std::deque<CapturedFrame> pending;
+	std::vector<std::vector<uint8_t>> freeImages;	// memory of written frames, reused by the next ones
+	int32_t numFrames = 0;
+	int32_t numWritten = 0;
+	bool active = false;
+	bool quit = false;
+};
+
+static DwGFrameCapture g_capture;
+
+static uint32_t dwgCrc32(uint32_t crc, const uint8_t* data, size_t size)
+{
+	static uint32_t table[256];
+	static std::once_flag tableFlag;
+
+	std::call_once(tableFlag, [] {
+		for (uint32_t n = 0; n < 256; ++n)
+		{
+			uint32_t c = n;
+			for (int32_t k = 0; k < 8; ++k)
+			{
+				c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+			}
+			table[n] = c;
+		}
+	});
+
+	crc = ~crc;
+	for (size_t i = 0; i < size; ++i)
+	{
+		crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+	}
+	return ~crc;
+}
+
+static void dwgPushBigEndian(std::vector<uint8_t>& out, uint32_t value)
+{
+	out.push_back((uint8_t)(value >> 24));
+	out.push_back((uint8_t)(value >> 16));
+	out.push_back((uint8_t)(value >> 8));
+	out.push_back((uint8_t)value);
+}
+
+// appends length, type, data and crc of the chunk, data are already at the end of out (after the type)
+static void dwgEndPngChunk(std::vector<uint8_t>& out, size_t chunkStart)
+{
+	const size_t dataSize = out.size() - chunkStart - 8;
+	const uint32_t length = (uint32_t)dataSize;
+
+	out[chunkStart + 0] = (uint8_t)(length >> 24);
+	out[chunkStart + 1] = (uint8_t)(length >> 16);
+	out[chunkStart + 2] = (uint8_t)(length >> 8);
+	out[chunkStart + 3] = (uint8_t)length;
+
+	dwgPushBigEndian(out, dwgCrc32(0, &out[chunkStart + 4], dataSize + 4));
+}
+
+static size_t dwgBeginPngChunk(std::vector<uint8_t>& out, const char* type)
+{
+	const size_t chunkStart = out.size();
+	dwgPushBigEndian(out, 0);	// length, filled by dwgEndPngChunk
+	out.insert(out.end(), type, type + 4);
+	return chunkStart;
+}
+
+static void dwgEncodePng(std::vector<uint8_t>& out, const uint8_t* rgba, int32_t width, int32_t height)
+{
+	static const uint8_t signature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+
+	const size_t rowSize = (size_t)width * 4;
+	const size_t rawSize = (rowSize + 1) * height;	// every row starts with filter type 0
+	const size_t numBlocks = rawSize / 65535 + 1;
+
+	out.clear();
+	out.reserve(sizeof(signature) + 25 + 12 + 6 + rawSize + numBlocks * 5 + 12);
+	out.insert(out.end(), signature, signature + sizeof(signature));
+
+	// 8 bit rgba, no interlace
+	size_t chunk = dwgBeginPngChunk(out, "IHDR");
+	dwgPushBigEndian(out, (uint32_t)width);
+	dwgPushBigEndian(out, (uint32_t)height);
+	const uint8_t header[] = { 8, 6, 0, 0, 0 };
+	out.insert(out.end(), header, header + sizeof(header));
+	dwgEndPngChunk(out, chunk);
+
+	// zlib stream of stored deflate blocks, at most 65535 bytes each
+	chunk = dwgBeginPngChunk(out, "IDAT");
+	out.push_back(0x78);
+	out.push_back(0x01);
+
+	uint32_t adlerA = 1;
+	uint32_t adlerB = 0;
+	size_t blockLeft = 0;
+	size_t rawLeft = rawSize;
+
+	for (int32_t y = 0; y < height; ++y)
+	{
+		const uint8_t filter = 0;
+		const uint8_t* row = rgba + rowSize * y;
+
+		for (size_t i = 0; i < rowSize + 1; )
+		{
+			if (blockLeft == 0)
+			{
+				blockLeft = rawLeft < 65535 ? rawLeft : 65535;
+				rawLeft -= blockLeft;
+
+				out.push_back(rawLeft == 0 ? 1 : 0);	// final block flag, stored type
+				out.push_back((uint8_t)blockLeft);
+				out.push_back((uint8_t)(blockLeft >> 8));
+				out.push_back((uint8_t)~blockLeft);
+				out.push_back((uint8_t)(~blockLeft >> 8));
+			}
+
+			// the filter byte, then as much of the row as fits to the block
+			const uint8_t* data = i == 0 ? &filter : row + i - 1;
+			size_t size = i == 0 ? 1 : rowSize + 1 - i;
+			size = size < blockLeft ? size : blockLeft;
+
+			out.insert(out.end(), data, data + size);
+			for (size_t k = 0; k < size; ++k)
+			{
+				adlerA += data[k];
+				adlerB += adlerA;
+
+				// no overflow before the modulo for at least 5552 bytes, per byte is simpler
+				if (adlerA >= 65521)
+					adlerA -= 65521;
+				if (adlerB >= 65521)
+					adlerB -= 65521;
+			}
+
+			i += size;
+			blockLeft -= size;
+		}
+	}
+
+	// an empty image has no block yet, the stream still needs the final one
+	if (rawSize == 0)
+	{
+		const uint8_t emptyBlock[] = { 1, 0, 0, 0xff, 0xff };
+		out.insert(out.end(), emptyBlock, emptyBlock + sizeof(emptyBlock));
+	}
+
+	dwgPushBigEndian(out, (adlerB << 16) | adlerA);
+	dwgEndPngChunk(out, chunk);
+
+	chunk = dwgBeginPngChunk(out, "IEND");
+	dwgEndPngChunk(out, chunk);
+}
+
+static bool dwgWriteFile(const char* path, const uint8_t* data, size_t size)
+{
+	FILE* file = fopen(path, "wb");
+	if (!file)
+	{
+		fprintf(stderr, "Error: can't write %s\n", path);
+		return false;
+	}
+
+	const bool written = fwrite(data, 1, size, file) == size;
+	fclose(file);
+	return written;
+}
+
+bool dwgWritePng(const char* path, const uint8_t* rgba, int32_t width, int32_t height)
+{
+	std::vector<uint8_t> png;
+	dwgEncodePng(png, rgba, width, height);
+	return dwgWriteFile(path, png.data(), png.size());
+}
+
+static void dwgCaptureWriterLoop()
+{
+	std::vector<uint8_t> encoded;
+	char path[1024];
+
+	while (true)
+	{
+		CapturedFrame frame;
+		{
+			std::unique_lock<std::mutex> lock(g_capture.mutex);
+			g_capture.pendingCondition.wait(lock, [] { return g_capture.quit || !g_capture.pending.empty(); });
+
+			// pending frames are written before quitting
+			if (g_capture.pending.empty())
+				return;
+
+			frame = std::move(g_capture.pending.front());
+			g_capture.pending.pop_front();
+		}
+
+		snprintf(path, sizeof(path), g_capture.pathFormat.c_str(), frame.index);
+
+		if (g_capture.format == CaptureFormat::Png)
+		{
+			dwgEncodePng(encoded, frame.rgba.data(), frame.width, frame.height);
+			dwgWriteFile(path, encoded.data(), encoded.size());
+		}
+		else
+		{
+			dwgWriteFile(path, frame.rgba.data(), frame.rgba.size());
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(g_capture.mutex);
+			g_capture.freeImages.push_back(std::move(frame.rgba));
+			g_capture.numWritten += 1;
+		}
+		g_capture.writtenCondition.notify_all();
+	}
+}
+
+// the path format goes to snprintf with one int, so it has to have exactly one int conversion ("%%" is allowed)
+// flags, width and precision are fine, length modifiers and other conversions are not
+static bool dwgValidPathFormat(const char* pathFormat)
+{
+	int32_t numConversions = 0;
+	for (const char* c = pathFormat; *c; ++c)
+	{
+		if (*c != '%')
+			continue;
+
+		c += 1;
+		if (*c == '%')
+			continue;
+
+		while (*c && strchr("-+ #0", *c))
+			c += 1;
+		while (*c >= '0' && *c <= '9')
+			c += 1;
+		if (*c == '.')
+		{
+			c += 1;
+			while (*c >= '0' && *c <= '9')
+				c += 1;
+		}
+
+		if (*c == 0 || !strchr("diuoxX", *c))
+			return false;
+
+		numConversions += 1;
+	}
+
+	return numConversions == 1;
+}
+
+bool dwgCaptureBegin(const char* pathFormat, CaptureFormat format, int32_t maxPendingFrames)
+{
+	dwgCaptureEnd();
+
+	if (pathFormat == nullptr || !dwgValidPathFormat(pathFormat))
+	{
+		fprintf(stderr, "Error: the capture path needs exactly one integer conversion for the frame index, e.g. frame_%%05d.png\n");
+		return false;
+	}
+
+	g_capture.pathFormat = pathFormat;
+	g_capture.format = format;
+	g_capture.maxPendingFrames = maxPendingFrames > 1 ? maxPendingFrames : 1;
+	g_capture.numFrames = 0;
+	g_capture.numWritten = 0;
+	g_capture.quit = false;
+	g_capture.active = true;
+	g_capture.writer = std::thread(dwgCaptureWriterLoop);
+
+	return true;
+}
+
+void dwgCaptureFrame(const uint8_t* rgba, int32_t width, int32_t height, bool bottomUp)
+{
+	if (!g_capture.active)
+		return;
+
+	CapturedFrame frame;
+	{
+		std::unique_lock<std::mutex> lock(g_capture.mutex);
+		g_capture.writtenCondition.wait(lock, [] { return (int32_t)g_capture.pending.size() < g_capture.maxPendingFrames; });
+
+		if (!g_capture.freeImages.empty())
+		{
+			frame.rgba = std::move(g_capture.freeImages.back());
+			g_capture.freeImages.pop_back();
+		}
+	}
+
+	const size_t rowSize = (size_t)width * 4;
+	frame.index = g_capture.numFrames++;
+	frame.width = width;
+	frame.height = height;
+	frame.rgba.resize(rowSize * height);
+
+	for (int32_t y = 0; y < height; ++y)
+	{
+		const int32_t srcRow = bottomUp ? height - 1 - y : y;
+		memcpy(&frame.rgba[rowSize * y], rgba + rowSize * srcRow, rowSize);
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(g_capture.mutex);
+		g_capture.pending.push_back(std::move(frame));
+	}
+	g_capture.pendingCondition.notify_one();
+}
+
+void dwgCaptureEnd()
+{
+	if (!g_capture.active)
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(g_capture.mutex);
+		g_capture.quit = true;
+	}
+	g_capture.pendingCondition.notify_one();
+
+	g_capture.writer.join();
+	g_capture.active = false;
+	g_capture.freeImages.clear();
+}
+
+bool dwgCaptureActive()
+{
+	return g_capture.active;
+}
+
+int32_t dwgCaptureNumWritten()
+{
+	std::lock_guard<std::mutex> lock(g_capture.mutex);
+	return g_capture.numWritten;
+}
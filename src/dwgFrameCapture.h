@@ -0,0 +1,34 @@
+#pragma once
+
+#include <stdint.h>
+
+// captured frames are encoded and written to disk by a background thread, so the render loop doesn't wait for the disk
+//
+//	dwgCaptureBegin("capture/frame_%05d.png", CaptureFormat::Png);
+//	...
+//	dwgCaptureFrame(pixels, width, height, false);	// every frame
+//	...
+//	dwgCaptureEnd();	// writes the frames that are still pending
+enum class CaptureFormat
+{
+	Png,	// rgba8 png with uncompressed deflate blocks (no zlib), fast to write and any viewer opens it
+	Raw,	// rgba8 rows from top to bottom without any header
+};
+
+// pathFormat gets the frame index (printf format), e.g. "frame_%05d.png", returns false unless it has exactly one int conversion
+// at most maxPendingFrames wait for the writer thread, dwgCaptureFrame blocks when there are more
+bool dwgCaptureBegin(const char* pathFormat, CaptureFormat format, int32_t maxPendingFrames = 4);
+
+// copies the image and queues it for writing, bottomUp flips the rows (OpenGL read back)
+void dwgCaptureFrame(const uint8_t* rgba, int32_t width, int32_t height, bool bottomUp);
+
+// waits until the pending frames are written and stops the writer thread
+void dwgCaptureEnd();
+
+bool dwgCaptureActive();
+
+// number of frames written since dwgCaptureBegin
+int32_t dwgCaptureNumWritten();
+
+// encodes and writes the png on the calling thread, rows from top to bottom
+bool dwgWritePng(const char* path, const uint8_t* rgba, int32_t width, int32_t height);
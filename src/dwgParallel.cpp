@@ -0,0 +1,207 @@
+#include "dwgParallel.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define DWG_PARALLEL_CSR 1
+#endif
+
+struct DwGParallelJob
+{
+	const std::function<void(int32_t, int32_t)>* func = nullptr;
+	int32_t count = 0;
+	int32_t grainSize = 1;
+	int32_t numChunks = 0;
+	uint32_t csr = 0;	// SSE control and status register of the calling thread
+
+	std::atomic<int32_t> nextChunk{ 0 };
+	std::atomic<int32_t> chunksDone{ 0 };
+};
+
+struct DwGThreadPool
+{
+	std::vector<std::thread> workers;
+
+	std::mutex mutex;
+	std::condition_variable wakeCondition;	// workers wait here for the next job
+	std::condition_variable doneCondition;	// dwgParallelFor waits here for the chunks and workers to finish
+
+	DwGParallelJob job;
+	uint64_t generation = 0;	// incremented for every job
+	int32_t activeWorkers = 0;	// workers that are currently picking chunks of the job
+	bool quit = false;
+
+	~DwGThreadPool();
+};
+
+static void dwgRunChunks(DwGThreadPool& pool)
+{
+	DwGParallelJob& job = pool.job;
+
+#if DWG_PARALLEL_CSR
+	// flush to zero and denormals are zero change the results, every chunk has to run with the same flags
+	const uint32_t csr = _mm_getcsr();
+	_mm_setcsr(job.csr);
+#endif
+
+	while (true)
+	{
+		const int32_t chunk = job.nextChunk.fetch_add(1);
+		if (chunk >= job.numChunks)
+			break;
+
+		const int32_t begin = chunk * job.grainSize;
+		const int32_t end = begin + job.grainSize < job.count ? begin + job.grainSize : job.count;
+		(*job.func)(begin, end);
+
+		if (job.chunksDone.fetch_add(1) + 1 == job.numChunks)
+		{
+			std::lock_guard<std::mutex> lock(pool.mutex);
+			pool.doneCondition.notify_all();
+		}
+	}
+
+#if DWG_PARALLEL_CSR
+	_mm_setcsr(csr);
+#endif
+}
+
+static void dwgWorkerLoop(DwGThreadPool* pool)
+{
+	uint64_t seenGeneration;
+	{
+		// a worker created by dwgParallelSetThreadCount must not run the last job again
+		std::lock_guard<std::mutex> lock(pool->mutex);
+		seenGeneration = pool->generation;
+	}
+
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(pool->mutex);
+			pool->wakeCondition.wait(lock, [&] { return pool->quit || pool->generation != seenGeneration; });
+
+			if (pool->quit)
+				return;
+
+			seenGeneration = pool->generation;
+			pool->activeWorkers += 1;
+		}
+
+		dwgRunChunks(*pool);
+
+		{
+			std::lock_guard<std::mutex> lock(pool->mutex);
+			pool->activeWorkers -= 1;
+			pool->doneCondition.notify_all();
+		}
+	}
+}
+
+static void dwgStopWorkers(DwGThreadPool& pool)
+{
+	{
+		std::lock_guard<std::mutex> lock(pool.mutex);
+		pool.quit = true;
+	}
+	pool.wakeCondition.notify_all();
+
+	for (std::thread& worker : pool.workers)
+		worker.join();
+
+	pool.workers.clear();
+	pool.quit = false;
+}
+
+static void dwgStartWorkers(DwGThreadPool& pool, int32_t numThreads)
+{
+	if (numThreads <= 0)
+	{
+		numThreads = (int32_t)std::thread::hardware_concurrency();
+	}
+
+	// the calling thread is one of them
+	for (int32_t i = 1; i < numThreads; ++i)
+	{
+		pool.workers.emplace_back(dwgWorkerLoop, &pool);
+	}
+}
+
+DwGThreadPool::~DwGThreadPool()
+{
+	dwgStopWorkers(*this);
+}
+
+static DwGThreadPool& dwgThreadPool()
+{
+	// created on first use, worker threads are joined at exit
+	static DwGThreadPool pool;
+	static std::once_flag initFlag;
+
+	std::call_once(initFlag, [] {
+		dwgStartWorkers(pool, 0);
+	});
+
+	return pool;
+}
+
+int32_t dwgParallelThreadCount()
+{
+	return (int32_t)dwgThreadPool().workers.size() + 1;
+}
+
+void dwgParallelSetThreadCount(int32_t numThreads)
+{
+	DwGThreadPool& pool = dwgThreadPool();
+	dwgStopWorkers(pool);
+	dwgStartWorkers(pool, numThreads);
+}
+
+void dwgParallelFor(int32_t count, int32_t grainSize, const std::function<void(int32_t begin, int32_t end)>& func)
+{
+	if (count <= 0)
+		return;
+
+	if (grainSize < 1)
+		grainSize = 1;
+
+	const int32_t numChunks = (count + grainSize - 1) / grainSize;
+	DwGThreadPool& pool = dwgThreadPool();
+
+	// not worth waking up the workers
+	if (numChunks == 1 || pool.workers.empty())
+	{
+		for (int32_t begin = 0; begin < count; begin += grainSize)
+		{
+			func(begin, begin + grainSize < count ? begin + grainSize : count);
+		}
+		return;
+	}
+
+	{
+		// workers that are still leaving the previous job have to finish before the job is replaced
+		std::unique_lock<std::mutex> lock(pool.mutex);
+		pool.doneCondition.wait(lock, [&] { return pool.activeWorkers == 0; });
+
+		pool.job.func = &func;
+		pool.job.count = count;
+		pool.job.grainSize = grainSize;
+		pool.job.numChunks = numChunks;
+#if DWG_PARALLEL_CSR
+		pool.job.csr = _mm_getcsr();
+#endif
+		pool.job.nextChunk = 0;
+		pool.job.chunksDone = 0;
+		pool.generation += 1;
+	}
+	pool.wakeCondition.notify_all();
+
+	dwgRunChunks(pool);
+
+	std::unique_lock<std::mutex> lock(pool.mutex);
+	pool.doneCondition.wait(lock, [&] { return pool.job.chunksDone == pool.job.numChunks; });
+}
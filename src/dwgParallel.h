@@ -0,0 +1,18 @@
+#pragma once
+
+#include <stdint.h>
+#include <functional>
+
+// number of threads that work on dwgParallelFor (worker threads + the calling thread)
+int32_t dwgParallelThreadCount();
+
+// changes the number of threads (0 = one per hardware thread), call it only when no dwgParallelFor is running
+// results of the solver don't depend on it, it's there to check that and to leave cores to other work
+void dwgParallelSetThreadCount(int32_t numThreads);
+
+// calls func(begin, end) for chunks of [0, count), each chunk has at most grainSize elements
+// chunks are processed by worker threads and the calling thread, returns when all chunks are done
+// chunk boundaries depend only on count and grainSize, never on the number of threads
+// workers run with the floating point control flags (rounding, denormals) of the calling thread
+// note: not reentrant, don't call it from inside of func
+void dwgParallelFor(int32_t count, int32_t grainSize, const std::function<void(int32_t begin, int32_t end)>& func);
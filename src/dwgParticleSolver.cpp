@@ -0,0 +1,2041 @@
+#include "dwgParticleSolver.h"
+#include "dwgParallel.h"
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <float.h>
+#include <functional>
+#include <queue>
+
+// how many constrains/particles a single job of the parallel loops gets
+#define DWG_SOLVER_GRAIN_SIZE 1024
+
+// corrections of both particles of the elastic distance constrain
+// returns false if the constrain can't move any of its particles, error is |displacement| before the correction
+//
+// displacement is the difference between the distance we want to keep and the actual distance
+// every particle gets the part of it weighted by its mass (0 = static, so the other particle gets everything)
+// compliance is the inverse stiffness (0 = stiff), it's added to the weights so the correction is softer
+static inline bool dwgDistanceCorrection(const ElasticDistance& c, const Particle& p0, const Particle& p1, float dt, Vector3& delta0, Vector3& delta1, float& error)
+{
+	const float alpha = c.compliance / dt;
+	const float weight = p0.mass + p1.mass + alpha;
+
+	const Vector3 diff = p1.pos - p0.pos;
+	const float distance = length(diff);
+
+	const float displacement = c.distance - distance;
+	error = fabsf(displacement);
+
+	// slack tether
+	if (c.broken || (c.unilateral && displacement >= 0.f))
+	{
+		error = 0.f;
+		return false;
+	}
+
+	if (weight <= 0.f || distance <= 0.f)
+		return false;
+	const Vector3 dir = diff / distance;
+
+	delta0 = -dir * displacement * (p0.mass / weight);
+	delta1 = dir * displacement * (p1.mass / weight);
+	return true;
+}
+
+static int32_t dwgFindRoot(std::vector<int32_t>& parent, int32_t i)
+{
+	while (parent[i] != i)
+	{
+		parent[i] = parent[parent[i]];
+		i = parent[i];
+	}
+	return i;
+}
+
+// connected components of dynamic particles (union-find), static particles don't connect anything
+static void dwgSolverBuildIslands(ParticleSolver& solver)
+{
+	const int32_t numParticles = (int32_t)solver.particles.size();
+
+	std::vector<int32_t> parent(numParticles);
+	for (int32_t i = 0; i < numParticles; ++i)
+	{
+		parent[i] = i;
+	}
+
+	for (const ElasticDistance& c : solver.constrains)
+	{
+		if (c.broken || solver.particles[c.idx_a].mass <= 0.f || solver.particles[c.idx_b].mass <= 0.f)
+			continue;
+
+		const int32_t rootA = dwgFindRoot(parent, c.idx_a);
+		const int32_t rootB = dwgFindRoot(parent, c.idx_b);
+		if (rootA != rootB)
+		{
+			parent[rootA > rootB ? rootA : rootB] = rootA < rootB ? rootA : rootB;
+		}
+	}
+
+	// islands are numbered in the order of their first particle
+	solver.islands.clear();
+	solver.particleIsland.assign(numParticles, -1);
+	solver.particleIslandSlots.assign(numParticles, -1);
+	std::vector<int32_t> rootIsland(numParticles, -1);
+
+	for (int32_t i = 0; i < numParticles; ++i)
+	{
+		if (solver.particles[i].mass <= 0.f)
+			continue;
+
+		const int32_t root = dwgFindRoot(parent, i);
+		if (rootIsland[root] < 0)
+		{
+			rootIsland[root] = (int32_t)solver.islands.size();
+			solver.islands.emplace_back();
+		}
+
+		solver.particleIsland[i] = rootIsland[root];
+		solver.particleIslandSlots[i] = (int32_t)solver.islands[rootIsland[root]].particles.size();
+		solver.islands[rootIsland[root]].particles.push_back(i);
+	}
+
+	// constrain belongs to the island of its dynamic particle, constrains between static particles to none
+	solver.constrainIslandSlots.assign(solver.constrains.size(), -1);
+	for (int32_t i = 0; i < (int32_t)solver.constrains.size(); ++i)
+	{
+		const ElasticDistance& c = solver.constrains[i];
+		const int32_t island = solver.particleIsland[c.idx_a] >= 0 ? solver.particleIsland[c.idx_a] : solver.particleIsland[c.idx_b];
+		if (island >= 0 && !c.broken)
+		{
+			solver.constrainIslandSlots[i] = (int32_t)solver.islands[island].constrains.size();
+			solver.islands[island].constrains.push_back(i);
+		}
+	}
+
+	solver.searchMarks.assign(numParticles, 0);
+	solver.searchStamp = 0;
+
+	// new islands are awake
+	solver.splitConstrains.clear();
+	solver.numSleepingIslands = 0;
+	solver.awakeParticlesDirty = true;
+}
+
+void dwgSolverBuild(ParticleSolver& solver)
+{
+	const int32_t numParticles = (int32_t)solver.particles.size();
+	const int32_t numConstrains = (int32_t)solver.constrains.size();
+
+	// count constrains per particle, then turn the counts into offsets (CSR)
+	solver.particleConstrainOffsets.assign(numParticles + 1, 0);
+	solver.particleConstrainCounts.assign(numParticles, 0);
+	solver.hasTearableConstrains = false;
+	for (const ElasticDistance& c : solver.constrains)
+	{
+		if (c.broken)
+			continue;
+
+		solver.particleConstrainOffsets[c.idx_a + 1] += 1;
+		solver.particleConstrainOffsets[c.idx_b + 1] += 1;
+		solver.particleConstrainCounts[c.idx_a] += 1;
+		solver.particleConstrainCounts[c.idx_b] += 1;
+		solver.hasTearableConstrains = solver.hasTearableConstrains || c.tearStretch > 0.f;
+	}
+
+	for (int32_t i = 0; i < numParticles; ++i)
+	{
+		solver.particleConstrainOffsets[i + 1] += solver.particleConstrainOffsets[i];
+	}
+
+	// fill the refs in constrain order, so the sum of the corrections is always done in the same order
+	std::vector<int32_t> fill(solver.particleConstrainOffsets.begin(), solver.particleConstrainOffsets.end() - 1);
+	solver.particleConstrainRefs.resize(solver.particleConstrainOffsets[numParticles]);
+	for (int32_t i = 0; i < numConstrains; ++i)
+	{
+		const ElasticDistance& c = solver.constrains[i];
+		if (c.broken)
+			continue;
+
+		solver.particleConstrainRefs[fill[c.idx_a]++] = 2 * i + 0;
+		solver.particleConstrainRefs[fill[c.idx_b]++] = 2 * i + 1;
+	}
+
+	solver.constrainCorrections.assign(2 * numConstrains, Vector3(0.f));
+	solver.constrainActive.assign(numConstrains, 0);
+	solver.constrainErrors.assign(numConstrains, 0.f);
+
+	dwgSolverBuildIslands(solver);
+}
+
+// removes the ref from the range of the particle, the refs after it move down to keep the order
+static void dwgRemoveConstrainRef(ParticleSolver& solver, int32_t particle, int32_t ref)
+{
+	const int32_t first = solver.particleConstrainOffsets[particle];
+	int32_t& count = solver.particleConstrainCounts[particle];
+
+	int32_t r = first;
+	while (r < first + count && solver.particleConstrainRefs[r] != ref)
+	{
+		r += 1;
+	}
+	if (r == first + count)
+		return;
+
+	for (; r < first + count - 1; ++r)
+	{
+		solver.particleConstrainRefs[r] = solver.particleConstrainRefs[r + 1];
+	}
+	count -= 1;
+}
+
+static inline int32_t dwgConstrainIsland(const ParticleSolver& solver, const ElasticDistance& c)
+{
+	return solver.particleIsland[c.idx_a] >= 0 ? solver.particleIsland[c.idx_a] : solver.particleIsland[c.idx_b];
+}
+
+// the last constrain of the island takes the free slot
+static void dwgIslandRemoveConstrain(ParticleSolver& solver, int32_t islandIndex, int32_t constrain)
+{
+	std::vector<int32_t>& constrains = solver.islands[islandIndex].constrains;
+	const int32_t slot = solver.constrainIslandSlots[constrain];
+
+	constrains[slot] = constrains.back();
+	solver.constrainIslandSlots[constrains[slot]] = slot;
+	constrains.pop_back();
+	solver.constrainIslandSlots[constrain] = -1;
+}
+
+static void dwgIslandAddConstrain(ParticleSolver& solver, int32_t islandIndex, int32_t constrain)
+{
+	std::vector<int32_t>& constrains = solver.islands[islandIndex].constrains;
+	solver.constrainIslandSlots[constrain] = (int32_t)constrains.size();
+	constrains.push_back(constrain);
+}
+
+void dwgSolverBreakConstrain(ParticleSolver& solver, int32_t constrain)
+{
+	ElasticDistance& c = solver.constrains[constrain];
+	if (c.broken)
+		return;
+
+	c.broken = true;
+	dwgRemoveConstrainRef(solver, c.idx_a, 2 * constrain + 0);
+	dwgRemoveConstrainRef(solver, c.idx_b, 2 * constrain + 1);
+
+	const int32_t islandIndex = dwgConstrainIsland(solver, c);
+	if (islandIndex < 0)
+		return;
+
+	dwgSolverWakeIsland(solver, islandIndex);
+	dwgIslandRemoveConstrain(solver, islandIndex, constrain);
+
+	// tethers never hold an island together, any other constrain may have split it or cut it from the static particles
+	const bool tether = c.unilateral && (solver.particles[c.idx_a].mass <= 0.f || solver.particles[c.idx_b].mass <= 0.f);
+	if (!tether)
+	{
+		solver.splitConstrains.push_back(constrain);
+	}
+}
+
+// breaks the tethers from the static particle to the island when no two sided constrain connects them anymore
+static void dwgUpdateAnchor(ParticleSolver& solver, int32_t anchor, int32_t islandIndex)
+{
+	const int32_t first = solver.particleConstrainOffsets[anchor];
+	const int32_t count = solver.particleConstrainCounts[anchor];
+
+	for (int32_t r = first; r < first + count; ++r)
+	{
+		const int32_t ref = solver.particleConstrainRefs[r];
+		const ElasticDistance& c = solver.constrains[ref >> 1];
+		if (!c.unilateral && solver.particleIsland[ref & 1 ? c.idx_a : c.idx_b] == islandIndex)
+			return;
+	}
+
+	// breaking removes the refs of the anchor
+	std::vector<int32_t> tethers;
+	for (int32_t r = first; r < first + count; ++r)
+	{
+		const int32_t ref = solver.particleConstrainRefs[r];
+		const ElasticDistance& c = solver.constrains[ref >> 1];
+		if (c.unilateral && solver.particleIsland[ref & 1 ? c.idx_a : c.idx_b] == islandIndex)
+		{
+			tethers.push_back(ref >> 1);
+		}
+	}
+
+	for (int32_t i : tethers)
+	{
+		dwgSolverBreakConstrain(solver, i);
+	}
+}
+
+// two searches from the ends of the broken constrain take turns, one particle each
+// when they meet, the island is still connected, when one of them runs out of particles, it found the smaller part
+// only the smaller part moves to a new island, so a tear costs the size of the part that falls off, not of the whole island
+static void dwgSplitIsland(ParticleSolver& solver, int32_t particleA, int32_t particleB)
+{
+	const int32_t islandIndex = solver.particleIsland[particleA];
+
+	// marks of this search are stamp + side, older marks are smaller
+	solver.searchStamp += 2;
+	const int32_t stamp = solver.searchStamp;
+
+	std::vector<int32_t>* searched = solver.searchParticles;
+	int32_t heads[2] = { 0, 0 };
+	searched[0].assign(1, particleA);
+	searched[1].assign(1, particleB);
+	solver.searchMarks[particleA] = stamp + 0;
+	solver.searchMarks[particleB] = stamp + 1;
+
+	int32_t side = 0;
+	while (heads[side] < (int32_t)searched[side].size())
+	{
+		const int32_t p = searched[side][heads[side]++];
+
+		const int32_t first = solver.particleConstrainOffsets[p];
+		for (int32_t r = first; r < first + solver.particleConstrainCounts[p]; ++r)
+		{
+			const int32_t ref = solver.particleConstrainRefs[r];
+			const ElasticDistance& c = solver.constrains[ref >> 1];
+			const int32_t other = ref & 1 ? c.idx_a : c.idx_b;
+
+			if (solver.particles[other].mass <= 0.f || solver.searchMarks[other] == stamp + side)
+				continue;
+
+			if (solver.searchMarks[other] == stamp + 1 - side)
+				return;
+
+			solver.searchMarks[other] = stamp + side;
+			searched[side].push_back(other);
+		}
+
+		side = 1 - side;
+	}
+
+	// the searched side is the whole part, it gets a new island with its particles and constrains in the order they were found
+	const int32_t partIndex = (int32_t)solver.islands.size();
+	solver.islands.emplace_back();
+
+	// static particles connected to the part by two sided constrains, the part keeps only tethers to them
+	solver.searchStamp += 2;
+	const int32_t anchorMark = solver.searchStamp;
+	std::vector<int32_t> anchors;
+	std::vector<int32_t> tethers;
+
+	for (int32_t p : searched[side])
+	{
+		std::vector<int32_t>& particles = solver.islands[islandIndex].particles;
+		const int32_t slot = solver.particleIslandSlots[p];
+		particles[slot] = particles.back();
+		solver.particleIslandSlots[particles[slot]] = slot;
+		particles.pop_back();
+
+		solver.particleIsland[p] = partIndex;
+		solver.particleIslandSlots[p] = (int32_t)solver.islands[partIndex].particles.size();
+		solver.islands[partIndex].particles.push_back(p);
+
+		const int32_t first = solver.particleConstrainOffsets[p];
+		for (int32_t r = first; r < first + solver.particleConstrainCounts[p]; ++r)
+		{
+			const int32_t ref = solver.particleConstrainRefs[r];
+			const ElasticDistance& c = solver.constrains[ref >> 1];
+			const int32_t other = ref & 1 ? c.idx_a : c.idx_b;
+			const bool otherStatic = solver.particles[other].mass <= 0.f;
+
+			// constrains inside the part are seen from both particles, they move once
+			if (otherStatic || (ref & 1) == 0)
+			{
+				dwgIslandRemoveConstrain(solver, islandIndex, ref >> 1);
+				dwgIslandAddConstrain(solver, partIndex, ref >> 1);
+			}
+
+			if (otherStatic && c.unilateral)
+			{
+				tethers.push_back(ref >> 1);
+			}
+			else if (otherStatic && solver.searchMarks[other] != anchorMark)
+			{
+				solver.searchMarks[other] = anchorMark;
+				anchors.push_back(other);
+			}
+		}
+	}
+
+	for (int32_t i : tethers)
+	{
+		const ElasticDistance& c = solver.constrains[i];
+		if (solver.searchMarks[solver.particles[c.idx_a].mass <= 0.f ? c.idx_a : c.idx_b] != anchorMark)
+		{
+			dwgSolverBreakConstrain(solver, i);
+		}
+	}
+
+	// the rest of the island may have been connected to some of the static particles only through the part
+	for (int32_t anchor : anchors)
+	{
+		dwgUpdateAnchor(solver, anchor, islandIndex);
+	}
+}
+
+void dwgSolverSplitIslands(ParticleSolver& solver)
+{
+	for (size_t k = 0; k < solver.splitConstrains.size(); ++k)
+	{
+		const ElasticDistance& c = solver.constrains[solver.splitConstrains[k]];
+		const bool staticA = solver.particles[c.idx_a].mass <= 0.f;
+		const bool staticB = solver.particles[c.idx_b].mass <= 0.f;
+
+		if (staticA != staticB)
+		{
+			dwgUpdateAnchor(solver, staticA ? c.idx_a : c.idx_b, solver.particleIsland[staticA ? c.idx_b : c.idx_a]);
+		}
+		else if (solver.particleIsland[c.idx_a] == solver.particleIsland[c.idx_b])
+		{
+			// otherwise an earlier constrain of the list already split them
+			dwgSplitIsland(solver, c.idx_a, c.idx_b);
+		}
+	}
+	solver.splitConstrains.clear();
+}
+
+void dwgSolverTear(ParticleSolver& solver)
+{
+	solver.stats.numTornConstrains = 0;
+	if (!solver.hasTearableConstrains)
+		return;
+
+	const int32_t numConstrains = (int32_t)solver.constrains.size();
+	const int32_t numChunks = (numConstrains + DWG_SOLVER_GRAIN_SIZE - 1) / DWG_SOLVER_GRAIN_SIZE;
+	solver.partials.resize(numChunks);
+
+	auto overstretched = [&](const ElasticDistance& c)
+	{
+		return c.tearStretch > 0.f && !c.broken && lengthSqr(solver.particles[c.idx_b].pos - solver.particles[c.idx_a].pos) > (c.tearStretch * c.distance) * (c.tearStretch * c.distance);
+	};
+
+	// count overstretched constrains per chunk in parallel, tearing is rare, so most chunks are done after this
+	dwgParallelFor(numConstrains, DWG_SOLVER_GRAIN_SIZE, [&](int32_t begin, int32_t end)
+	{
+		float count = 0.f;
+		for (int32_t i = begin; i < end; ++i)
+		{
+			count += overstretched(solver.constrains[i]) ? 1.f : 0.f;
+		}
+		solver.partials[begin / DWG_SOLVER_GRAIN_SIZE] = count;
+	});
+
+	// break them in constrain order, breaking doesn't move particles, so the test gives the same answer
+	for (int32_t chunk = 0; chunk < numChunks; ++chunk)
+	{
+		if (solver.partials[chunk] == 0.f)
+			continue;
+
+		const int32_t end = (chunk + 1) * DWG_SOLVER_GRAIN_SIZE < numConstrains ? (chunk + 1) * DWG_SOLVER_GRAIN_SIZE : numConstrains;
+		for (int32_t i = chunk * DWG_SOLVER_GRAIN_SIZE; i < end; ++i)
+		{
+			if (overstretched(solver.constrains[i]))
+			{
+				dwgSolverBreakConstrain(solver, i);
+				solver.stats.numTornConstrains += 1;
+			}
+		}
+	}
+
+	dwgSolverSplitIslands(solver);
+}
+
+// neighbours of every particle through the two sided constrains (CSR)
+static void dwgBuildNeighbours(const ParticleSolver& solver, std::vector<int32_t>& offsets, std::vector<int32_t>& neighbours, std::vector<float>& distances)
+{
+	const int32_t numParticles = (int32_t)solver.particles.size();
+
+	offsets.assign(numParticles + 1, 0);
+	for (const ElasticDistance& c : solver.constrains)
+	{
+		if (c.unilateral || c.broken)
+			continue;
+		offsets[c.idx_a + 1] += 1;
+		offsets[c.idx_b + 1] += 1;
+	}
+
+	for (int32_t i = 0; i < numParticles; ++i)
+	{
+		offsets[i + 1] += offsets[i];
+	}
+
+	std::vector<int32_t> fill(offsets.begin(), offsets.end() - 1);
+	neighbours.resize(offsets[numParticles]);
+	distances.resize(offsets[numParticles]);
+	for (const ElasticDistance& c : solver.constrains)
+	{
+		if (c.unilateral || c.broken)
+			continue;
+		distances[fill[c.idx_a]] = c.distance;
+		neighbours[fill[c.idx_a]++] = c.idx_b;
+		distances[fill[c.idx_b]] = c.distance;
+		neighbours[fill[c.idx_b]++] = c.idx_a;
+	}
+}
+
+void dwgSolverAddBendingConstrains(ParticleSolver& solver, float compliance)
+{
+	std::vector<int32_t> offsets, neighbours;
+	std::vector<float> distances;
+	dwgBuildNeighbours(solver, offsets, neighbours, distances);
+
+	// cos of the biggest angle between the two constrains that still counts as a straight line
+	const float straightCos = -0.9f;
+
+	for (int32_t p = 0; p < (int32_t)solver.particles.size(); ++p)
+	{
+		for (int32_t i = offsets[p]; i < offsets[p + 1]; ++i)
+		{
+			for (int32_t j = offsets[p]; j < offsets[p + 1]; ++j)
+			{
+				const int32_t a = neighbours[i];
+				const int32_t b = neighbours[j];
+
+				// every pair once, and never between two static particles
+				if (a >= b || solver.particles[a].mass + solver.particles[b].mass <= 0.f)
+					continue;
+
+				const Vector3 toA = solver.particles[a].pos - solver.particles[p].pos;
+				const Vector3 toB = solver.particles[b].pos - solver.particles[p].pos;
+				if (dot(toA, toB) > straightCos * length(toA) * length(toB))
+					continue;
+
+				ElasticDistance c;
+				c.idx_a = a;
+				c.idx_b = b;
+				c.distance = length(solver.particles[b].pos - solver.particles[a].pos);
+				c.compliance = compliance;
+				solver.constrains.push_back(c);
+			}
+		}
+	}
+}
+
+void dwgSolverAddTethers(ParticleSolver& solver, float compliance)
+{
+	const int32_t numParticles = (int32_t)solver.particles.size();
+
+	std::vector<int32_t> offsets, neighbours;
+	std::vector<float> distances;
+	dwgBuildNeighbours(solver, offsets, neighbours, distances);
+
+	// dijkstra from all static particles at once, every particle remembers the static particle it was reached from
+	std::vector<float> pathLength(numParticles, FLT_MAX);
+	std::vector<int32_t> anchor(numParticles, -1);
+
+	typedef std::pair<float, int32_t> QueueItem;
+	std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+
+	for (int32_t i = 0; i < numParticles; ++i)
+	{
+		if (solver.particles[i].mass <= 0.f)
+		{
+			pathLength[i] = 0.f;
+			anchor[i] = i;
+			queue.push(QueueItem(0.f, i));
+		}
+	}
+
+	while (!queue.empty())
+	{
+		const QueueItem item = queue.top();
+		queue.pop();
+
+		const int32_t p = item.second;
+		if (item.first > pathLength[p])
+			continue;
+
+		for (int32_t n = offsets[p]; n < offsets[p + 1]; ++n)
+		{
+			const int32_t next = neighbours[n];
+			const float nextLength = pathLength[p] + distances[n];
+
+			if (nextLength < pathLength[next])
+			{
+				pathLength[next] = nextLength;
+				anchor[next] = anchor[p];
+				queue.push(QueueItem(nextLength, next));
+			}
+		}
+	}
+
+	for (int32_t i = 0; i < numParticles; ++i)
+	{
+		// particles that aren't connected to any static particle can't be attached
+		if (solver.particles[i].mass <= 0.f || anchor[i] < 0)
+			continue;
+
+		ElasticDistance c;
+		c.idx_a = anchor[i];
+		c.idx_b = i;
+		c.distance = pathLength[i];
+		c.compliance = compliance;
+		c.unilateral = true;
+		solver.constrains.push_back(c);
+	}
+}
+
+static float dwgMillisecondsSince(std::chrono::steady_clock::time_point& time)
+{
+	const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	const float ms = std::chrono::duration<float, std::milli>(now - time).count();
+	time = now;
+	return ms;
+}
+
+// sorted list of particles that are not in a sleeping island (static particles are always in it)
+static void dwgUpdateAwakeParticles(ParticleSolver& solver)
+{
+	const int32_t numParticles = (int32_t)solver.particles.size();
+	if (!solver.awakeParticlesDirty && (solver.numSleepingIslands > 0 || (int32_t)solver.awakeParticles.size() == numParticles))
+		return;
+
+	solver.awakeParticles.clear();
+	for (int32_t i = 0; i < numParticles; ++i)
+	{
+		const int32_t island = i < (int32_t)solver.particleIsland.size() ? solver.particleIsland[i] : -1;
+		if (island < 0 || !solver.islands[island].sleeping)
+		{
+			solver.awakeParticles.push_back(i);
+		}
+	}
+
+	solver.awakeParticlesDirty = false;
+}
+
+static inline float dwgSegmentDistanceSqr(const Vector3& point, const Vector3& a, const Vector3& b)
+{
+	const Vector3 ab = b - a;
+	const float abSqr = lengthSqr(ab);
+
+	float t = abSqr > 0.f ? dot(point - a, ab) / abSqr : 0.f;
+	t = t < 0.f ? 0.f : (t > 1.f ? 1.f : t);
+	return lengthSqr(point - (a + ab * t));
+}
+
+// wakes up sleeping islands touched by the sphere colliders on their way from prevPos to pos
+// bounds of the island are tested first, then its particles
+static void dwgWakeTouchedIslands(ParticleSolver& solver)
+{
+	if (solver.numSleepingIslands == 0)
+		return;
+
+	for (const SphereCollider& col : solver.colliders)
+	{
+		const float collisionDistance = col.radius + solver.particleRadius;
+		const Vector3 low = minPerElem(col.pos, col.prevPos) - Vector3(collisionDistance);
+		const Vector3 high = maxPerElem(col.pos, col.prevPos) + Vector3(collisionDistance);
+
+		for (int32_t i = 0; i < (int32_t)solver.islands.size(); ++i)
+		{
+			const SolverIsland& island = solver.islands[i];
+			if (!island.sleeping)
+				continue;
+
+			if (low.getX() > island.boundsMax.getX() || low.getY() > island.boundsMax.getY() || low.getZ() > island.boundsMax.getZ() ||
+				high.getX() < island.boundsMin.getX() || high.getY() < island.boundsMin.getY() || high.getZ() < island.boundsMin.getZ())
+				continue;
+
+			for (int32_t p : island.particles)
+			{
+				if (dwgSegmentDistanceSqr(solver.particles[p].pos, col.prevPos, col.pos) < collisionDistance * collisionDistance)
+				{
+					dwgSolverWakeIsland(solver, i);
+					break;
+				}
+			}
+		}
+	}
+}
+
+void dwgSolverWakeIsland(ParticleSolver& solver, int32_t islandIndex)
+{
+	SolverIsland& island = solver.islands[islandIndex];
+	if (!island.sleeping)
+		return;
+
+	island.sleeping = false;
+	island.sleepTime = 0.f;
+	solver.numSleepingIslands -= 1;
+
+	// the rest of the step sees the particles, the list is sorted again at the start of the next one
+	solver.awakeParticles.insert(solver.awakeParticles.end(), island.particles.begin(), island.particles.end());
+	solver.awakeParticlesDirty = true;
+}
+
+void dwgSolverBeginFrame(ParticleSolver& solver)
+{
+	solver.frameIterationTime = 0.f;
+}
+
+void dwgSolverStep(ParticleSolver& solver, float dt)
+{
+	SolverStats& stats = solver.stats;
+	std::chrono::steady_clock::time_point time = std::chrono::steady_clock::now();
+
+	dwgSolverIntegrate(solver, solver.gravity, dt);
+	stats.integrateTime = dwgMillisecondsSince(time);
+
+	stats.numIterations = solver.numIterations;
+	stats.numIslandIterations = solver.numIterations * ((int32_t)solver.islands.size() - solver.numSleepingIslands);
+	dwgSolverConstrains(solver, dt);
+	dwgSolverTear(solver);
+	stats.constrainsTime = dwgMillisecondsSince(time);
+
+	dwgSolverSelfCollisions(solver);
+	dwgSolverCollisions(solver);
+	stats.collisionTime = dwgMillisecondsSince(time);
+
+	stats.numAwakeParticles = (int32_t)solver.awakeParticles.size();
+	dwgSolverUpdateVelocities(solver, dt);
+	dwgSolverUpdateSleeping(solver, dt);
+	stats.velocityTime = dwgMillisecondsSince(time);
+	stats.numSleepingIslands = solver.numSleepingIslands;
+	stats.stateHash = solver.deterministic ? dwgSolverStateHash(solver) : 0;
+
+	if (solver.measureError)
+	{
+		dwgSolverMeasureError(solver, stats.maxError, stats.rmsError);
+	}
+
+	if (!solver.statsHistory.empty())
+	{
+		const int32_t capacity = (int32_t)solver.statsHistory.size();
+		solver.statsHistory[solver.statsHistoryHead] = stats;
+		solver.statsHistoryHead = (solver.statsHistoryHead + 1) % capacity;
+		solver.statsHistoryCount = solver.statsHistoryCount < capacity ? solver.statsHistoryCount + 1 : capacity;
+	}
+}
+
+void dwgSolverIntegrate(ParticleSolver& solver, const Vector3& acceleration, float dt)
+{
+	for (SphereCollider& col : solver.colliders)
+	{
+		if (col.mass <= 0.f)
+			continue;
+
+		col.vel += acceleration * dt;
+		col.pos += col.vel * dt;
+		col.rotation = normalize(col.rotation + Quat(col.angularVel * (0.5f * dt), 0.f) * col.rotation);
+	}
+
+	dwgWakeTouchedIslands(solver);
+	dwgUpdateAwakeParticles(solver);
+
+	for (int32_t i : solver.awakeParticles)
+	{
+		Particle& p = solver.particles[i];
+		p.prevPos = p.pos;
+
+		// if the particle has a mass of 0 (should be static) then we don't want to move it
+		if (p.mass <= 0.f)
+			continue;
+
+		p.vel += acceleration * dt;
+		p.pos += p.vel * dt;
+	}
+}
+
+static void dwgSolveGaussSeidel(ParticleSolver& solver, float dt)
+{
+	for (const ElasticDistance& c : solver.constrains)
+	{
+		Particle& p0 = solver.particles[c.idx_a];
+		Particle& p1 = solver.particles[c.idx_b];
+
+		Vector3 delta0, delta1;
+		float error;
+		if (dwgDistanceCorrection(c, p0, p1, dt, delta0, delta1, error))
+		{
+			p0.pos += delta0;
+			p1.pos += delta1;
+		}
+	}
+}
+
+static void dwgSolveJacobi(ParticleSolver& solver, float dt)
+{
+	// every constrain reads positions of the previous iterate and writes only its own corrections
+	dwgParallelFor((int32_t)solver.constrains.size(), DWG_SOLVER_GRAIN_SIZE, [&](int32_t begin, int32_t end)
+	{
+		for (int32_t i = begin; i < end; ++i)
+		{
+			const ElasticDistance& c = solver.constrains[i];
+
+			Vector3& delta0 = solver.constrainCorrections[2 * i + 0];
+			Vector3& delta1 = solver.constrainCorrections[2 * i + 1];
+
+			float error;
+			solver.constrainActive[i] = dwgDistanceCorrection(c, solver.particles[c.idx_a], solver.particles[c.idx_b], dt, delta0, delta1, error);
+			if (!solver.constrainActive[i])
+			{
+				delta0 = Vector3(0.f);
+				delta1 = Vector3(0.f);
+			}
+		}
+	});
+
+	// every particle gathers the corrections of its constrains, so no two threads write to the same particle
+	dwgParallelFor((int32_t)solver.particles.size(), DWG_SOLVER_GRAIN_SIZE, [&](int32_t begin, int32_t end)
+	{
+		for (int32_t i = begin; i < end; ++i)
+		{
+			Particle& p = solver.particles[i];
+
+			const int32_t first = solver.particleConstrainOffsets[i];
+			const int32_t numRefs = solver.particleConstrainCounts[i];
+			if (numRefs == 0 || p.mass <= 0.f)
+				continue;
+
+			Vector3 sum(0.f);
+			int32_t numActive = 0;
+			for (int32_t r = first; r < first + numRefs; ++r)
+			{
+				const int32_t ref = solver.particleConstrainRefs[r];
+				sum += solver.constrainCorrections[ref];
+				numActive += solver.constrainActive[ref / 2];
+			}
+
+			// average of the corrections, otherwise particles with many constrains overshoot
+			// slack tethers don't count, they would only slow down the active ones
+			if (numActive > 0)
+				p.pos += sum * (solver.jacobiRelaxation / (float)numActive);
+		}
+	});
+}
+
+static void dwgSolveIteration(ParticleSolver& solver, float dt)
+{
+	if (solver.mode == SolverMode::Jacobi)
+	{
+		dwgSolveJacobi(solver, dt);
+	}
+	else
+	{
+		dwgSolveGaussSeidel(solver, dt);
+	}
+}
+
+// Chebyshev semi-iterative method (Wang 2015, "A Chebyshev Semi-Iterative Approach for Accelerating Projective and Position-based Dynamics")
+// q(k+1) = omega(k+1) * (iterate(q(k)) - q(k-1)) + q(k-1)
+// omega grows from 1 towards 2 / (1 + sqrt(1 - rho^2)), where rho is the spectral radius of the plain iterations
+static void dwgSolveChebyshev(ParticleSolver& solver, float dt)
+{
+	const int32_t numParticles = (int32_t)solver.particles.size();
+	const int32_t numChunks = (numParticles + DWG_SOLVER_GRAIN_SIZE - 1) / DWG_SOLVER_GRAIN_SIZE;
+	const int32_t delay = solver.chebyshevDelay < 2 ? 2 : solver.chebyshevDelay;
+
+	solver.chebyshevIterPos.resize(numParticles);
+	solver.chebyshevPrevPos.resize(numParticles);
+	solver.partials.resize(numChunks);
+	solver.chebyshevRestarts = 0;
+
+	float rho = solver.chebyshevRho;
+	float omega = 1.f;
+	float prevUpdate = 0.f;
+	float ratioSum = 0.f;
+	int32_t numRatios = 0;
+	int32_t restartIteration = 0;
+
+	for (int32_t k = 0; k < solver.numIterations; ++k)
+	{
+		// q(k)
+		dwgParallelFor(numParticles, DWG_SOLVER_GRAIN_SIZE, [&](int32_t begin, int32_t end)
+		{
+			for (int32_t i = begin; i < end; ++i)
+			{
+				solver.chebyshevIterPos[i] = solver.particles[i].pos;
+			}
+		});
+
+		dwgSolveIteration(solver, dt);
+
+		const int32_t j = k - restartIteration;
+		if (j < delay)
+		{
+			omega = 1.f;
+		}
+		else if (j == delay)
+		{
+			omega = 2.f / (2.f - rho * rho);
+		}
+		else
+		{
+			omega = 4.f / (4.f - rho * rho * omega);
+		}
+
+		// measure how much the plain iteration moved the particles and extrapolate
+		dwgParallelFor(numParticles, DWG_SOLVER_GRAIN_SIZE, [&](int32_t begin, int32_t end)
+		{
+			float sum = 0.f;
+			for (int32_t i = begin; i < end; ++i)
+			{
+				Particle& p = solver.particles[i];
+				if (p.mass <= 0.f)
+					continue;
+
+				const Vector3 iterated = p.pos;
+				sum += lengthSqr(iterated - solver.chebyshevIterPos[i]);
+
+				if (omega != 1.f)
+				{
+					const Vector3& prev = solver.chebyshevPrevPos[i];
+					p.pos = (iterated - prev) * omega + prev;
+				}
+
+				solver.chebyshevPrevPos[i] = solver.chebyshevIterPos[i];
+			}
+			solver.partials[begin / DWG_SOLVER_GRAIN_SIZE] = sum;
+		});
+
+		float update = 0.f;
+		for (float partial : solver.partials)
+		{
+			update += partial;
+		}
+		update = sqrtf(update);
+
+		if (j > 0 && j < delay && prevUpdate > 0.f)
+		{
+			// plain iterations shrink the update roughly by rho every iteration
+			ratioSum += update / prevUpdate;
+			numRatios += 1;
+		}
+		else if (j > delay && update > prevUpdate)
+		{
+			// diverging, go back to plain iterations and be more careful with the extrapolation
+			restartIteration = k + 1;
+			rho *= 0.8f;
+			solver.chebyshevRestarts += 1;
+		}
+
+		prevUpdate = update;
+	}
+
+	// smooth the estimate between steps, the ratio of a single step is noisy
+	if (numRatios > 0)
+	{
+		float measured = ratioSum / (float)numRatios;
+		measured = measured < 0.f ? 0.f : (measured > 0.99f ? 0.99f : measured);
+		rho = rho * 0.8f + measured * 0.2f;
+	}
+
+	solver.chebyshevRho = rho;
+}
+
+// one iteration of the active islands, fills maxError of every active island
+static void dwgSolveIslandsIteration(ParticleSolver& solver, float dt)
+{
+	if (solver.mode == SolverMode::GaussSeidel)
+	{
+		for (int32_t islandIndex : solver.activeIslands)
+		{
+			SolverIsland& island = solver.islands[islandIndex];
+			island.maxError = 0.f;
+
+			for (int32_t i : island.constrains)
+			{
+				const ElasticDistance& c = solver.constrains[i];
+				Particle& p0 = solver.particles[c.idx_a];
+				Particle& p1 = solver.particles[c.idx_b];
+
+				Vector3 delta0, delta1;
+				float error;
+				if (dwgDistanceCorrection(c, p0, p1, dt, delta0, delta1, error))
+				{
+					p0.pos += delta0;
+					p1.pos += delta1;
+				}
+
+				island.maxError = error > island.maxError ? error : island.maxError;
+			}
+		}
+		return;
+	}
+
+	// jacobi over constrains and particles of the active islands only
+	solver.activeConstrains.clear();
+	solver.activeParticles.clear();
+	for (int32_t islandIndex : solver.activeIslands)
+	{
+		const SolverIsland& island = solver.islands[islandIndex];
+		solver.activeConstrains.insert(solver.activeConstrains.end(), island.constrains.begin(), island.constrains.end());
+		solver.activeParticles.insert(solver.activeParticles.end(), island.particles.begin(), island.particles.end());
+	}
+
+	dwgParallelFor((int32_t)solver.activeConstrains.size(), DWG_SOLVER_GRAIN_SIZE, [&](int32_t begin, int32_t end)
+	{
+		for (int32_t a = begin; a < end; ++a)
+		{
+			const int32_t i = solver.activeConstrains[a];
+			const ElasticDistance& c = solver.constrains[i];
+
+			Vector3& delta0 = solver.constrainCorrections[2 * i + 0];
+			Vector3& delta1 = solver.constrainCorrections[2 * i + 1];
+
+			solver.constrainActive[i] = dwgDistanceCorrection(c, solver.particles[c.idx_a], solver.particles[c.idx_b], dt, delta0, delta1, solver.constrainErrors[i]);
+			if (!solver.constrainActive[i])
+			{
+				delta0 = Vector3(0.f);
+				delta1 = Vector3(0.f);
+			}
+		}
+	});
+
+	dwgParallelFor((int32_t)solver.activeParticles.size(), DWG_SOLVER_GRAIN_SIZE, [&](int32_t begin, int32_t end)
+	{
+		for (int32_t a = begin; a < end; ++a)
+		{
+			const int32_t i = solver.activeParticles[a];
+			Particle& p = solver.particles[i];
+
+			const int32_t first = solver.particleConstrainOffsets[i];
+			const int32_t numRefs = solver.particleConstrainCounts[i];
+			if (numRefs == 0)
+				continue;
+
+			Vector3 sum(0.f);
+			int32_t numActive = 0;
+			for (int32_t r = first; r < first + numRefs; ++r)
+			{
+				const int32_t ref = solver.particleConstrainRefs[r];
+				sum += solver.constrainCorrections[ref];
+				numActive += solver.constrainActive[ref / 2];
+			}
+
+			if (numActive > 0)
+				p.pos += sum * (solver.jacobiRelaxation / (float)numActive);
+		}
+	});
+
+	dwgParallelFor((int32_t)solver.activeIslands.size(), 64, [&](int32_t begin, int32_t end)
+	{
+		for (int32_t a = begin; a < end; ++a)
+		{
+			SolverIsland& island = solver.islands[solver.activeIslands[a]];
+			island.maxError = 0.f;
+
+			for (int32_t i : island.constrains)
+			{
+				island.maxError = solver.constrainErrors[i] > island.maxError ? solver.constrainErrors[i] : island.maxError;
+			}
+		}
+	});
+}
+
+// islands iterate until their error is below the tolerance, numIterations times at most
+static void dwgSolveAdaptive(ParticleSolver& solver, float dt)
+{
+	std::chrono::steady_clock::time_point time = std::chrono::steady_clock::now();
+
+	solver.activeIslands.clear();
+	for (int32_t i = 0; i < (int32_t)solver.islands.size(); ++i)
+	{
+		SolverIsland& island = solver.islands[i];
+		island.numIterations = 0;
+		island.maxError = 0.f;
+
+		if (!island.constrains.empty() && !island.sleeping)
+		{
+			solver.activeIslands.push_back(i);
+		}
+	}
+
+	int32_t numIterations = 0;
+	int32_t numIslandIterations = 0;
+
+	while (!solver.activeIslands.empty() && numIterations < solver.numIterations)
+	{
+		dwgSolveIslandsIteration(solver, dt);
+
+		numIterations += 1;
+		numIslandIterations += (int32_t)solver.activeIslands.size();
+
+		// errors were measured before the corrections of this iteration, so a converged island is even better now
+		int32_t numActive = 0;
+		for (int32_t islandIndex : solver.activeIslands)
+		{
+			SolverIsland& island = solver.islands[islandIndex];
+			island.numIterations += 1;
+
+			if (island.maxError >= solver.errorTolerance)
+			{
+				solver.activeIslands[numActive++] = islandIndex;
+			}
+		}
+		solver.activeIslands.resize(numActive);
+
+		// every island gets at least one iteration, then the budget of the frame decides (unless the time can't change the results)
+		solver.frameIterationTime += dwgMillisecondsSince(time);
+		if (solver.iterationTimeBudget > 0.f && solver.frameIterationTime >= solver.iterationTimeBudget && !solver.deterministic)
+			break;
+	}
+
+	solver.stats.numIterations = numIterations;
+	solver.stats.numIslandIterations = numIslandIterations;
+}
+
+// all iterations over the awake islands only
+static void dwgSolveAwakeIslands(ParticleSolver& solver, float dt)
+{
+	solver.activeIslands.clear();
+	for (int32_t i = 0; i < (int32_t)solver.islands.size(); ++i)
+	{
+		const SolverIsland& island = solver.islands[i];
+		if (!island.constrains.empty() && !island.sleeping)
+		{
+			solver.activeIslands.push_back(i);
+		}
+	}
+
+	for (int32_t i = 0; i < solver.numIterations; ++i)
+	{
+		dwgSolveIslandsIteration(solver, dt);
+	}
+}
+
+void dwgSolverConstrains(ParticleSolver& solver, float dt)
+{
+	if (solver.adaptiveIterations)
+	{
+		dwgSolveAdaptive(solver, dt);
+		return;
+	}
+
+	// islands don't share dynamic particles, so solving them one by one gives the same result as solving everything
+	if (solver.numSleepingIslands > 0)
+	{
+		dwgSolveAwakeIslands(solver, dt);
+		return;
+	}
+
+	// with fewer iterations there is nothing to accelerate
+	if (solver.chebyshev && solver.numIterations > solver.chebyshevDelay)
+	{
+		dwgSolveChebyshev(solver, dt);
+		return;
+	}
+
+	for (int32_t i = 0; i < solver.numIterations; ++i)
+	{
+		dwgSolveIteration(solver, dt);
+	}
+}
+
+// coulomb friction of a particle touching the collider surface (normal points from the collider to the particle)
+// tangential movement of the particle relative to the surface point during the step is cancelled up to friction * penetration
+static inline void dwgSphereFriction(Particle& p, SphereCollider& col, const Vector3& normal, float penetration)
+{
+	// contact point relative to the center of the collider now and at the start of the step
+	const Vector3 r = normal * col.radius;
+	const Vector3 prevR = rotate(conj(col.rotation * conj(col.prevRotation)), r);
+
+	const Vector3 move = (p.pos - p.prevPos) - ((col.pos + r) - (col.prevPos + prevR));
+	const Vector3 tangent = move - normal * dot(move, normal);
+	const float tangentLength = length(tangent);
+
+	// solid sphere, the contact point moves by weight * |r|^2 / (0.4 * |r|^2) more thanks to the rotation
+	const float angularWeight = col.mass * 2.5f;
+	const float weight = p.mass + col.mass + angularWeight;
+	if (tangentLength <= 0.f || weight <= 0.f)
+		return;
+
+	const float correction = tangentLength < col.friction * penetration ? tangentLength : col.friction * penetration;
+	const Vector3 impulse = tangent * (correction / tangentLength / weight);
+
+	p.pos -= impulse * p.mass;
+	col.pos += impulse * col.mass;
+
+	if (col.mass > 0.f)
+	{
+		const Vector3 rotation = cross(r, impulse) * (col.mass / (0.4f * col.radius * col.radius));
+		col.rotation = normalize(col.rotation + Quat(rotation * 0.5f, 0.f) * col.rotation);
+	}
+}
+
+static inline void dwgCollideSphere(Particle& p, SphereCollider& col, float radius, bool continuous, int32_t& numSweptTests)
+{
+	// static particle touching a static collider, nothing can move
+	if (p.mass + col.mass <= 0.f)
+		return;
+
+	const float collisionDistance = col.radius + radius;
+
+	if (continuous)
+	{
+		// relative path of the particle in the space of the collider: start + t * move, t = 0..1
+		const Vector3 start = p.prevPos - col.prevPos;
+		const Vector3 move = (p.pos - p.prevPos) - (col.pos - col.prevPos);
+		const float moveSqr = lengthSqr(move);
+
+		// slow pairs can't tunnel, the discrete test below is enough for them
+		if (moveSqr > collisionDistance * collisionDistance && lengthSqr(start) > collisionDistance * collisionDistance)
+		{
+			numSweptTests += 1;
+
+			// |start + t * move| = collisionDistance
+			const float b = dot(start, move);
+			const float c = lengthSqr(start) - collisionDistance * collisionDistance;
+			const float discriminant = b * b - moveSqr * c;
+
+			if (discriminant >= 0.f)
+			{
+				const float t = (-b - sqrtf(discriminant)) / moveSqr;
+				if (t >= 0.f && t <= 1.f)
+				{
+					// put the particle at the contact point on the side it came from
+					const Vector3 normal = (start + move * t) / collisionDistance;
+					const Vector3 correction = col.pos + normal * collisionDistance - p.pos;
+
+					p.pos += correction * (p.mass / (p.mass + col.mass));
+					col.pos -= correction * (col.mass / (p.mass + col.mass));
+
+					// the same contact as the discrete one below, the depth is how far the particle was pushed back
+					if (col.friction > 0.f)
+					{
+						dwgSphereFriction(p, col, normal, length(correction));
+					}
+					return;
+				}
+			}
+		}
+	}
+
+	const Vector3 diff = col.pos - p.pos;
+	const float distance = length(diff);
+
+	// our actual distance between spheres
+	const float displacement = distance - collisionDistance;
+
+	if (displacement < 0.f && distance > 0.f)
+	{
+		const Vector3 dir = diff / distance;
+
+		p.pos += dir * displacement * (p.mass / (p.mass + col.mass));
+		col.pos += -dir * displacement * (col.mass / (p.mass + col.mass));
+
+		if (col.friction > 0.f)
+		{
+			dwgSphereFriction(p, col, -dir, -displacement);
+		}
+	}
+}
+
+// most cells a single collider is put into, bigger colliders are tested against every particle
+#define DWG_BROADPHASE_MAX_COLLIDER_CELLS 64
+
+static inline int32_t dwgCellCoord(float x, float invCellSize)
+{
+	return (int32_t)floorf(x * invCellSize);
+}
+
+static inline uint32_t dwgCellHash(int32_t x, int32_t y, int32_t z, uint32_t mask)
+{
+	return ((uint32_t)x * 73856093u ^ (uint32_t)y * 19349663u ^ (uint32_t)z * 83492791u) & mask;
+}
+
+// calls func(bucket) for every cell overlapped by the box
+// returns false (without calling func) if the box overlaps too many cells
+template<typename Func>
+static inline bool dwgForCells(const Vector3& low, const Vector3& high, float invCellSize, uint32_t mask, Func func)
+{
+	const int32_t minX = dwgCellCoord(low.getX(), invCellSize);
+	const int32_t minY = dwgCellCoord(low.getY(), invCellSize);
+	const int32_t minZ = dwgCellCoord(low.getZ(), invCellSize);
+	const int32_t maxX = dwgCellCoord(high.getX(), invCellSize);
+	const int32_t maxY = dwgCellCoord(high.getY(), invCellSize);
+	const int32_t maxZ = dwgCellCoord(high.getZ(), invCellSize);
+
+	if ((int64_t)(maxX - minX + 1) * (maxY - minY + 1) * (maxZ - minZ + 1) > DWG_BROADPHASE_MAX_COLLIDER_CELLS)
+		return false;
+
+	for (int32_t z = minZ; z <= maxZ; ++z)
+		for (int32_t y = minY; y <= maxY; ++y)
+			for (int32_t x = minX; x <= maxX; ++x)
+				func(dwgCellHash(x, y, z, mask));
+
+	return true;
+}
+
+// calls func(bucket) for every cell overlapped by the collider grown by the particle radius (from prevPos to pos with continuous collision)
+// returns false (without calling func) if the collider overlaps too many cells
+template<typename Func>
+static inline bool dwgForColliderCells(const SphereCollider& col, float particleRadius, bool continuous, float invCellSize, uint32_t mask, Func func)
+{
+	const Vector3 extent(col.radius + particleRadius);
+	const Vector3 low = (continuous ? minPerElem(col.pos, col.prevPos) : col.pos) - extent;
+	const Vector3 high = (continuous ? maxPerElem(col.pos, col.prevPos) : col.pos) + extent;
+
+	return dwgForCells(low, high, invCellSize, mask, func);
+}
+
+// counting sort of colliders into hash buckets of the cells they overlap
+// colliders with mass are pushed by the particles during the pass, so cells from its start would miss pairs, they are tested like the large ones
+static void dwgBuildColliderGrid(ParticleSolver& solver, float invCellSize)
+{
+	const int32_t numColliders = (int32_t)solver.colliders.size();
+	const float radius = solver.particleRadius;
+
+	// count the cells first, the table gets at least twice as many buckets
+	int32_t numEntries = 0;
+	for (const SphereCollider& col : solver.colliders)
+	{
+		if (col.mass <= 0.f)
+			dwgForColliderCells(col, radius, solver.continuousCollision, invCellSize, 0u, [&](uint32_t) { numEntries += 1; });
+	}
+
+	uint32_t numBuckets = 64;
+	while (numBuckets < 2u * (uint32_t)numEntries)
+	{
+		numBuckets *= 2;
+	}
+	const uint32_t mask = numBuckets - 1;
+
+	solver.colliderBuckets.assign(numBuckets + 1, 0);
+	solver.colliderLarge.clear();
+	for (int32_t i = 0; i < numColliders; ++i)
+	{
+		if (solver.colliders[i].mass > 0.f ||
+			!dwgForColliderCells(solver.colliders[i], radius, solver.continuousCollision, invCellSize, mask, [&](uint32_t bucket) { solver.colliderBuckets[bucket + 1] += 1; }))
+		{
+			solver.colliderLarge.push_back(i);
+		}
+	}
+
+	for (uint32_t b = 0; b < numBuckets; ++b)
+	{
+		solver.colliderBuckets[b + 1] += solver.colliderBuckets[b];
+	}
+
+	// colliders are added in index order, so every bucket is sorted by collider index
+	std::vector<int32_t> fill(solver.colliderBuckets.begin(), solver.colliderBuckets.end() - 1);
+	solver.colliderEntries.resize(solver.colliderBuckets[numBuckets]);
+	for (int32_t i = 0; i < numColliders; ++i)
+	{
+		if (solver.colliders[i].mass <= 0.f)
+			dwgForColliderCells(solver.colliders[i], radius, solver.continuousCollision, invCellSize, mask, [&](uint32_t bucket) { solver.colliderEntries[fill[bucket]++] = i; });
+	}
+}
+
+// colliders with mass are pushed out of the static shapes like a particle with the radius of the collider
+// the contact point is a static particle for the friction, so the collider slows down and rolls on the shapes
+static void dwgCollideRigidColliders(ParticleSolver& solver)
+{
+	for (SphereCollider& col : solver.colliders)
+	{
+		if (col.mass <= 0.f)
+			continue;
+
+		Particle body;
+		body.pos = col.pos;
+		body.prevPos = col.prevPos;
+		body.mass = col.mass;
+
+		Vector3 before = body.pos;
+		const auto contact = [&]()
+		{
+			const Vector3 push = body.pos - before;
+			const float depth = length(push);
+			if (depth > 0.f && col.friction > 0.f)
+			{
+				const Vector3 normal = -push / depth;
+				Particle surface;
+				surface.pos = body.pos + normal * col.radius;
+				surface.prevPos = surface.pos;
+				surface.mass = 0.f;
+
+				col.pos = body.pos;
+				dwgSphereFriction(surface, col, normal, depth);
+				body.pos = col.pos;
+			}
+			before = body.pos;
+		};
+
+		for (const CapsuleCollider& capsule : solver.capsules)
+		{
+			dwgCollideCapsule(capsule, &body, 1, col.radius);
+			contact();
+		}
+
+		for (const BoxCollider& box : solver.boxes)
+		{
+			dwgCollideBox(box, &body, 1, col.radius);
+			contact();
+		}
+
+		for (const PlaneCollider& plane : solver.planes)
+		{
+			dwgCollidePlane(plane, &body, 1, col.radius);
+			contact();
+		}
+
+		for (const MeshCollider& mesh : solver.meshes)
+		{
+			dwgCollideMesh(mesh, &body, 1, col.radius);
+			contact();
+		}
+
+		col.pos = body.pos;
+	}
+}
+
+// collision with the static shapes (they are only read, so particles are split between threads)
+static void dwgEndCollisions(ParticleSolver& solver)
+{
+	dwgCollideRigidColliders(solver);
+
+	if (!solver.capsules.empty() || !solver.boxes.empty() || !solver.planes.empty() || !solver.meshes.empty())
+	{
+		dwgParallelFor((int32_t)solver.awakeParticles.size(), DWG_SOLVER_GRAIN_SIZE, [&](int32_t begin, int32_t end)
+		{
+			// the kernels take arrays of particles, so every run of consecutive awake particles is passed at once
+			int32_t a = begin;
+			while (a < end)
+			{
+				int32_t runEnd = a + 1;
+				while (runEnd < end && solver.awakeParticles[runEnd] == solver.awakeParticles[runEnd - 1] + 1)
+				{
+					runEnd += 1;
+				}
+
+				Particle* particles = &solver.particles[solver.awakeParticles[a]];
+				const int32_t count = runEnd - a;
+				a = runEnd;
+
+				for (const CapsuleCollider& capsule : solver.capsules)
+					dwgCollideCapsule(capsule, particles, count, solver.particleRadius);
+
+				for (const BoxCollider& box : solver.boxes)
+					dwgCollideBox(box, particles, count, solver.particleRadius);
+
+				for (const PlaneCollider& plane : solver.planes)
+					dwgCollidePlane(plane, particles, count, solver.particleRadius);
+
+				for (const MeshCollider& mesh : solver.meshes)
+					dwgCollideMesh(mesh, particles, count, solver.particleRadius);
+			}
+		});
+	}
+}
+
+void dwgSolverCollisions(ParticleSolver& solver)
+{
+	const int32_t numParticles = (int32_t)solver.awakeParticles.size();
+	const int32_t numColliders = (int32_t)solver.colliders.size();
+	const float radius = solver.particleRadius;
+
+	const bool continuous = solver.continuousCollision;
+	solver.stats.numSweptTests = 0;
+
+	// few colliders, test everything with everything
+	if (numColliders <= solver.colliderBroadphaseThreshold)
+	{
+		for (int32_t i : solver.awakeParticles)
+		{
+			for (SphereCollider& col : solver.colliders)
+			{
+				dwgCollideSphere(solver.particles[i], col, radius, continuous, solver.stats.numSweptTests);
+			}
+		}
+
+		solver.stats.numCollisionTests = numParticles * numColliders;
+		dwgEndCollisions(solver);
+		return;
+	}
+
+	float cellSize = solver.colliderCellSize;
+	if (cellSize <= 0.f)
+	{
+		float radiusSum = 0.f;
+		for (const SphereCollider& col : solver.colliders)
+		{
+			radiusSum += col.radius;
+		}
+		cellSize = 2.f * (radiusSum / (float)numColliders + radius);
+	}
+
+	const float invCellSize = 1.f / cellSize;
+	dwgBuildColliderGrid(solver, invCellSize);
+
+	const uint32_t mask = (uint32_t)solver.colliderBuckets.size() - 2;
+	solver.colliderStamp.assign(numColliders, -1);
+
+	int32_t numTests = 0;
+	for (int32_t i : solver.awakeParticles)
+	{
+		Particle& p = solver.particles[i];
+
+		// a swept test needs the colliders of every cell the particle crossed, not only of the one it ended in
+		// they are tested in index order, so the order is the same as without the broadphase
+		if (continuous && (dwgCellCoord(p.pos.getX(), invCellSize) != dwgCellCoord(p.prevPos.getX(), invCellSize) ||
+			dwgCellCoord(p.pos.getY(), invCellSize) != dwgCellCoord(p.prevPos.getY(), invCellSize) ||
+			dwgCellCoord(p.pos.getZ(), invCellSize) != dwgCellCoord(p.prevPos.getZ(), invCellSize)))
+		{
+			std::vector<int32_t>& candidates = solver.colliderCandidates;
+			candidates.clear();
+
+			const bool fewCells = dwgForCells(minPerElem(p.pos, p.prevPos), maxPerElem(p.pos, p.prevPos), invCellSize, mask, [&](uint32_t bucket)
+			{
+				for (int32_t e = solver.colliderBuckets[bucket]; e < solver.colliderBuckets[bucket + 1]; ++e)
+				{
+					const int32_t c = solver.colliderEntries[e];
+					if (solver.colliderStamp[c] != i)
+					{
+						solver.colliderStamp[c] = i;
+						candidates.push_back(c);
+					}
+				}
+			});
+
+			// too long path, every collider is tested
+			if (!fewCells)
+			{
+				candidates.clear();
+				for (int32_t c = 0; c < numColliders; ++c)
+				{
+					candidates.push_back(c);
+				}
+			}
+			else
+			{
+				candidates.insert(candidates.end(), solver.colliderLarge.begin(), solver.colliderLarge.end());
+				std::sort(candidates.begin(), candidates.end());
+			}
+
+			for (int32_t c : candidates)
+			{
+				dwgCollideSphere(p, solver.colliders[c], radius, continuous, solver.stats.numSweptTests);
+			}
+
+			numTests += (int32_t)candidates.size();
+			continue;
+		}
+
+		// colliders were grown by the particle radius, so the cell of the particle center is enough
+		const uint32_t bucket = dwgCellHash(dwgCellCoord(p.pos.getX(), invCellSize), dwgCellCoord(p.pos.getY(), invCellSize), dwgCellCoord(p.pos.getZ(), invCellSize), mask);
+
+		// merge the bucket with the large colliders, both are sorted, so the order is the same as without the broadphase
+		int32_t e = solver.colliderBuckets[bucket];
+		const int32_t entriesEnd = solver.colliderBuckets[bucket + 1];
+		int32_t l = 0;
+		const int32_t numLarge = (int32_t)solver.colliderLarge.size();
+
+		while (e < entriesEnd || l < numLarge)
+		{
+			int32_t c;
+			if (l == numLarge || (e < entriesEnd && solver.colliderEntries[e] < solver.colliderLarge[l]))
+			{
+				c = solver.colliderEntries[e++];
+			}
+			else
+			{
+				c = solver.colliderLarge[l++];
+			}
+
+			// a collider can get into the same bucket from more cells
+			if (solver.colliderStamp[c] == i)
+				continue;
+
+			solver.colliderStamp[c] = i;
+			dwgCollideSphere(p, solver.colliders[c], radius, continuous, solver.stats.numSweptTests);
+		}
+
+		numTests += numLarge + entriesEnd - solver.colliderBuckets[bucket];
+	}
+
+	solver.stats.numCollisionTests = numTests;
+	dwgEndCollisions(solver);
+}
+
+// particles are sorted in a fixed number of chunks, so the order in buckets never depends on the number of threads
+#define DWG_SELF_COLLISION_SORT_CHUNKS 8
+
+// how many candidates are gathered before they are tested together
+#define DWG_SELF_COLLISION_BATCH 64
+
+// true if particles i and j are connected by a constrain
+static inline bool dwgConstrained(const ParticleSolver& solver, int32_t i, int32_t j)
+{
+	for (int32_t r = solver.particleConstrainOffsets[i]; r < solver.particleConstrainOffsets[i] + solver.particleConstrainCounts[i]; ++r)
+	{
+		const int32_t ref = solver.particleConstrainRefs[r];
+		const ElasticDistance& c = solver.constrains[ref >> 1];
+		if ((ref & 1 ? c.idx_a : c.idx_b) == j)
+			return true;
+	}
+	return false;
+}
+
+// counting sort of the particles into hash buckets of their cells
+// every sort chunk counts its particles per bucket, then the chunks scatter in parallel to their own ranges
+static void dwgSortParticles(ParticleSolver& solver, float invCellSize, uint32_t mask)
+{
+	const int32_t numParticles = (int32_t)solver.particles.size();
+	const int32_t numBuckets = (int32_t)mask + 1;
+	const int32_t chunkSize = (numParticles + DWG_SELF_COLLISION_SORT_CHUNKS - 1) / DWG_SELF_COLLISION_SORT_CHUNKS;
+
+	solver.particleBucket.resize(numParticles);
+	solver.particleBucketCounts.assign(DWG_SELF_COLLISION_SORT_CHUNKS * numBuckets, 0);
+	solver.particleBuckets.resize(numBuckets + 1);
+	solver.sortedParticles.resize(numParticles);
+
+	dwgParallelFor(DWG_SELF_COLLISION_SORT_CHUNKS, 1, [&](int32_t begin, int32_t end)
+	{
+		for (int32_t chunk = begin; chunk < end; ++chunk)
+		{
+			int32_t* counts = &solver.particleBucketCounts[chunk * numBuckets];
+			const int32_t last = (chunk + 1) * chunkSize < numParticles ? (chunk + 1) * chunkSize : numParticles;
+
+			for (int32_t i = chunk * chunkSize; i < last; ++i)
+			{
+				const Vector3& pos = solver.particles[i].pos;
+				const uint32_t bucket = dwgCellHash(dwgCellCoord(pos.getX(), invCellSize), dwgCellCoord(pos.getY(), invCellSize), dwgCellCoord(pos.getZ(), invCellSize), mask);
+
+				solver.particleBucket[i] = bucket;
+				counts[bucket] += 1;
+			}
+		}
+	});
+
+	// start of every bucket
+	solver.particleBuckets[0] = 0;
+	for (int32_t b = 0; b < numBuckets; ++b)
+	{
+		int32_t count = 0;
+		for (int32_t chunk = 0; chunk < DWG_SELF_COLLISION_SORT_CHUNKS; ++chunk)
+		{
+			count += solver.particleBucketCounts[chunk * numBuckets + b];
+		}
+		solver.particleBuckets[b + 1] = solver.particleBuckets[b] + count;
+	}
+
+	// turn the counts into the first slot of every chunk in every bucket
+	dwgParallelFor(numBuckets, 4096, [&](int32_t begin, int32_t end)
+	{
+		for (int32_t b = begin; b < end; ++b)
+		{
+			int32_t offset = solver.particleBuckets[b];
+			for (int32_t chunk = 0; chunk < DWG_SELF_COLLISION_SORT_CHUNKS; ++chunk)
+			{
+				const int32_t count = solver.particleBucketCounts[chunk * numBuckets + b];
+				solver.particleBucketCounts[chunk * numBuckets + b] = offset;
+				offset += count;
+			}
+		}
+	});
+
+	dwgParallelFor(DWG_SELF_COLLISION_SORT_CHUNKS, 1, [&](int32_t begin, int32_t end)
+	{
+		for (int32_t chunk = begin; chunk < end; ++chunk)
+		{
+			int32_t* fill = &solver.particleBucketCounts[chunk * numBuckets];
+			const int32_t last = (chunk + 1) * chunkSize < numParticles ? (chunk + 1) * chunkSize : numParticles;
+
+			for (int32_t i = chunk * chunkSize; i < last; ++i)
+			{
+				solver.sortedParticles[fill[solver.particleBucket[i]]++] = i;
+			}
+		}
+	});
+}
+
+// tests particle i against the gathered candidates, adds the corrections of the overlapping ones to delta
+// wakeIsland is set to the island of a touched sleeping particle
+static inline void dwgSelfCollideBatch(const ParticleSolver& solver, int32_t i, const float* xs, const float* ys, const float* zs, const int32_t* candidates, int32_t numCandidates, float minDistance, Vector3& delta, int32_t& wakeIsland)
+{
+	const Particle& p = solver.particles[i];
+	const float minDistanceSqr = minDistance * minDistance;
+
+	int32_t c = 0;
+
+#if VECTORMATH_MODE_SSE
+	// 4 candidates at once, most of them are far away, so only the mask is checked
+	const __m128 px = _mm_set1_ps(p.pos.getX());
+	const __m128 py = _mm_set1_ps(p.pos.getY());
+	const __m128 pz = _mm_set1_ps(p.pos.getZ());
+	const __m128 limit = _mm_set1_ps(minDistanceSqr);
+
+	for (; c + 4 <= numCandidates; c += 4)
+	{
+		const __m128 dx = _mm_sub_ps(_mm_loadu_ps(xs + c), px);
+		const __m128 dy = _mm_sub_ps(_mm_loadu_ps(ys + c), py);
+		const __m128 dz = _mm_sub_ps(_mm_loadu_ps(zs + c), pz);
+		const __m128 distanceSqr = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+
+		int mask = _mm_movemask_ps(_mm_cmplt_ps(distanceSqr, limit));
+		while (mask)
+		{
+			const int32_t lane = mask & 1 ? 0 : mask & 2 ? 1 : mask & 4 ? 2 : 3;
+			mask &= ~(1 << lane);
+
+			const int32_t j = candidates[c + lane];
+			const Particle& other = solver.particles[j];
+			if (p.mass + other.mass <= 0.f || dwgConstrained(solver, i, j))
+				continue;
+
+			const Vector3 diff = p.pos - other.pos;
+			const float distance = length(diff);
+			if (distance > 0.f)
+			{
+				delta += diff * ((minDistance - distance) / distance * (p.mass / (p.mass + other.mass)));
+			}
+
+			if (solver.numSleepingIslands > 0 && solver.particleIsland[j] >= 0 && solver.islands[solver.particleIsland[j]].sleeping)
+			{
+				wakeIsland = solver.particleIsland[j];
+			}
+		}
+	}
+#endif
+
+	for (; c < numCandidates; ++c)
+	{
+		const float dx = xs[c] - p.pos.getX();
+		const float dy = ys[c] - p.pos.getY();
+		const float dz = zs[c] - p.pos.getZ();
+		if (dx * dx + dy * dy + dz * dz >= minDistanceSqr)
+			continue;
+
+		const int32_t j = candidates[c];
+		const Particle& other = solver.particles[j];
+		if (p.mass + other.mass <= 0.f || dwgConstrained(solver, i, j))
+			continue;
+
+		const Vector3 diff = p.pos - other.pos;
+		const float distance = length(diff);
+		if (distance > 0.f)
+		{
+			delta += diff * ((minDistance - distance) / distance * (p.mass / (p.mass + other.mass)));
+		}
+
+		if (solver.numSleepingIslands > 0 && solver.particleIsland[j] >= 0 && solver.islands[solver.particleIsland[j]].sleeping)
+		{
+			wakeIsland = solver.particleIsland[j];
+		}
+	}
+}
+
+void dwgSolverSelfCollisions(ParticleSolver& solver)
+{
+	if (!solver.selfCollision)
+		return;
+
+	const int32_t numParticles = (int32_t)solver.particles.size();
+	const float minDistance = solver.selfCollisionDistance > 0.f ? solver.selfCollisionDistance : 2.f * solver.particleRadius;
+
+	// cells twice as big as the collision distance, then the neighbours are always in the 2x2x2 cells
+	// around the corner of the cell closest to the particle (8 hash lookups instead of 27)
+	const float invCellSize = 0.5f / minDistance;
+
+	uint32_t numBuckets = 64;
+	while (numBuckets < 2u * (uint32_t)numParticles)
+	{
+		numBuckets *= 2;
+	}
+	const uint32_t mask = numBuckets - 1;
+
+	// sleeping particles are sorted too, awake particles collide with them
+	dwgSortParticles(solver, invCellSize, mask);
+
+	const int32_t numAwake = (int32_t)solver.awakeParticles.size();
+	solver.selfCollisionCorrections.resize(numAwake);
+	solver.selfCollisionWakes.resize(numAwake);
+
+	// every awake particle gathers its own correction from the positions before this pass, so threads never write the same particle
+	dwgParallelFor(numAwake, DWG_SOLVER_GRAIN_SIZE, [&](int32_t begin, int32_t end)
+	{
+		float xs[DWG_SELF_COLLISION_BATCH];
+		float ys[DWG_SELF_COLLISION_BATCH];
+		float zs[DWG_SELF_COLLISION_BATCH];
+		int32_t candidates[DWG_SELF_COLLISION_BATCH];
+
+		for (int32_t a = begin; a < end; ++a)
+		{
+			const int32_t i = solver.awakeParticles[a];
+			const Particle& p = solver.particles[i];
+			Vector3 delta(0.f);
+			int32_t wakeIsland = -1;
+
+			if (p.mass > 0.f)
+			{
+				// first of the two cells on each axis, the cell below if the particle is in the lower half of its cell
+				const int32_t cellX = (int32_t)floorf(p.pos.getX() * invCellSize - 0.5f);
+				const int32_t cellY = (int32_t)floorf(p.pos.getY() * invCellSize - 0.5f);
+				const int32_t cellZ = (int32_t)floorf(p.pos.getZ() * invCellSize - 0.5f);
+
+				uint32_t visited[8];
+				int32_t numVisited = 0;
+				int32_t numCandidates = 0;
+
+				for (int32_t z = cellZ; z <= cellZ + 1; ++z)
+				for (int32_t y = cellY; y <= cellY + 1; ++y)
+				for (int32_t x = cellX; x <= cellX + 1; ++x)
+				{
+					// neighbouring cells can share a bucket, particles would be pushed twice
+					const uint32_t bucket = dwgCellHash(x, y, z, mask);
+					bool seen = false;
+					for (int32_t v = 0; v < numVisited; ++v)
+					{
+						seen = seen || visited[v] == bucket;
+					}
+					if (seen)
+						continue;
+					visited[numVisited++] = bucket;
+
+					for (int32_t e = solver.particleBuckets[bucket]; e < solver.particleBuckets[bucket + 1]; ++e)
+					{
+						const int32_t j = solver.sortedParticles[e];
+						if (j == i)
+							continue;
+
+						const Vector3& pos = solver.particles[j].pos;
+						xs[numCandidates] = pos.getX();
+						ys[numCandidates] = pos.getY();
+						zs[numCandidates] = pos.getZ();
+						candidates[numCandidates] = j;
+
+						if (++numCandidates == DWG_SELF_COLLISION_BATCH)
+						{
+							dwgSelfCollideBatch(solver, i, xs, ys, zs, candidates, numCandidates, minDistance, delta, wakeIsland);
+							numCandidates = 0;
+						}
+					}
+				}
+
+				dwgSelfCollideBatch(solver, i, xs, ys, zs, candidates, numCandidates, minDistance, delta, wakeIsland);
+			}
+
+			solver.selfCollisionCorrections[a] = delta;
+			solver.selfCollisionWakes[a] = wakeIsland;
+		}
+	});
+
+	dwgParallelFor(numAwake, DWG_SOLVER_GRAIN_SIZE, [&](int32_t begin, int32_t end)
+	{
+		for (int32_t a = begin; a < end; ++a)
+		{
+			solver.particles[solver.awakeParticles[a]].pos += solver.selfCollisionCorrections[a];
+		}
+	});
+
+	// touched islands wake up after the pass, they were only obstacles during it
+	if (solver.numSleepingIslands > 0)
+	{
+		for (int32_t a = 0; a < numAwake; ++a)
+		{
+			if (solver.selfCollisionWakes[a] >= 0)
+			{
+				dwgSolverWakeIsland(solver, solver.selfCollisionWakes[a]);
+			}
+		}
+	}
+}
+
+void dwgSolverUpdateVelocities(ParticleSolver& solver, float dt)
+{
+	for (int32_t i : solver.awakeParticles)
+	{
+		Particle& p = solver.particles[i];
+
+		// p.prevPos is the position before resolving constrains and collision
+		// so (p.pos - p.prevPos) / dt is the velocity the particle really had during the step
+		p.vel = (p.pos - p.prevPos) / dt;
+	}
+
+	for (SphereCollider& col : solver.colliders)
+	{
+		if (col.mass > 0.f)
+		{
+			col.vel = (col.pos - col.prevPos) / dt;
+
+			// rotation during the step, the shorter way around
+			const Quat delta = col.rotation * conj(col.prevRotation);
+			col.angularVel = delta.getXYZ() * ((delta.getW() < 0.f ? -2.f : 2.f) / dt);
+		}
+
+		col.prevPos = col.pos;
+		col.prevRotation = col.rotation;
+	}
+}
+
+void dwgSolverUpdateSleeping(ParticleSolver& solver, float dt)
+{
+	const int32_t numIslands = (int32_t)solver.islands.size();
+
+	if (!solver.sleeping)
+	{
+		// sleeping was turned off
+		for (int32_t i = 0; i < numIslands && solver.numSleepingIslands > 0; ++i)
+		{
+			dwgSolverWakeIsland(solver, i);
+		}
+		return;
+	}
+
+	// islands are independent, so every thread measures whole islands
+	dwgParallelFor(numIslands, 64, [&](int32_t begin, int32_t end)
+	{
+		for (int32_t i = begin; i < end; ++i)
+		{
+			SolverIsland& island = solver.islands[i];
+			if (island.sleeping)
+				continue;
+
+			float energy = 0.f;
+			for (int32_t p : island.particles)
+			{
+				energy += 0.5f * lengthSqr(solver.particles[p].vel);
+			}
+			island.kineticEnergy = energy / (float)island.particles.size();
+			island.sleepTime = island.kineticEnergy < solver.sleepEnergy ? island.sleepTime + dt : 0.f;
+		}
+	});
+
+	for (int32_t i = 0; i < numIslands; ++i)
+	{
+		SolverIsland& island = solver.islands[i];
+		if (island.sleeping || island.sleepTime < solver.sleepDelay)
+			continue;
+
+		// particles stop exactly where they are, prevPos = pos keeps them still when they wake up
+		island.sleeping = true;
+		island.boundsMin = solver.particles[island.particles[0]].pos;
+		island.boundsMax = island.boundsMin;
+
+		for (int32_t p : island.particles)
+		{
+			Particle& particle = solver.particles[p];
+			particle.vel = Vector3(0.f);
+			particle.prevPos = particle.pos;
+
+			island.boundsMin = minPerElem(island.boundsMin, particle.pos);
+			island.boundsMax = maxPerElem(island.boundsMax, particle.pos);
+		}
+
+		solver.numSleepingIslands += 1;
+		solver.awakeParticlesDirty = true;
+	}
+}
+
+// FNV-1a over 32 bit words instead of bytes, 4 times fewer multiplications
+static inline void dwgHashVector(uint64_t& hash, const Vector3& v)
+{
+	// only x, y and z, the 4th float of the SSE vector is garbage
+	const float xyz[3] = { v.getX(), v.getY(), v.getZ() };
+	uint32_t words[3];
+	memcpy(words, xyz, sizeof(words));
+
+	for (uint32_t word : words)
+	{
+		hash = (hash ^ word) * 1099511628211ull;
+	}
+}
+
+uint64_t dwgSolverStateHash(const ParticleSolver& solver)
+{
+	uint64_t hash = 14695981039346656037ull;
+
+	for (const Particle& p : solver.particles)
+	{
+		dwgHashVector(hash, p.pos);
+		dwgHashVector(hash, p.vel);
+	}
+
+	for (const SphereCollider& col : solver.colliders)
+	{
+		dwgHashVector(hash, col.pos);
+	}
+
+	return hash;
+}
+
+void dwgSolverInterpolate(const ParticleSolver& solver, float alpha, std::vector<Vector3>& positions)
+{
+	positions.resize(solver.particles.size());
+
+	dwgParallelFor((int32_t)solver.particles.size(), DWG_SOLVER_GRAIN_SIZE, [&](int32_t begin, int32_t end)
+	{
+		for (int32_t i = begin; i < end; ++i)
+		{
+			const Particle& p = solver.particles[i];
+			positions[i] = lerp(alpha, p.prevPos, p.pos);
+		}
+	});
+}
+
+void dwgSolverMeasureError(ParticleSolver& solver, float& maxError, float& rmsError)
+{
+	const int32_t numConstrains = (int32_t)solver.constrains.size();
+	const int32_t numChunks = (numConstrains + DWG_SOLVER_GRAIN_SIZE - 1) / DWG_SOLVER_GRAIN_SIZE;
+
+	// max, sum of squares and number of measured (not broken) constrains per chunk
+	solver.partials.resize(3 * numChunks);
+
+	dwgParallelFor(numConstrains, DWG_SOLVER_GRAIN_SIZE, [&](int32_t begin, int32_t end)
+	{
+		float chunkMax = 0.f;
+		float chunkSum = 0.f;
+		float chunkCount = 0.f;
+		for (int32_t i = begin; i < end; ++i)
+		{
+			const ElasticDistance& c = solver.constrains[i];
+			if (c.broken)
+				continue;
+
+			chunkCount += 1.f;
+
+			float error = length(solver.particles[c.idx_b].pos - solver.particles[c.idx_a].pos) - c.distance;
+			error = c.unilateral ? (error > 0.f ? error : 0.f) : fabsf(error);
+
+			chunkMax = error > chunkMax ? error : chunkMax;
+			chunkSum += error * error;
+		}
+
+		const int32_t chunk = begin / DWG_SOLVER_GRAIN_SIZE;
+		solver.partials[3 * chunk + 0] = chunkMax;
+		solver.partials[3 * chunk + 1] = chunkSum;
+		solver.partials[3 * chunk + 2] = chunkCount;
+	});
+
+	// torn constrains have no error, counting them would make tearing look like convergence
+	maxError = 0.f;
+	float sum = 0.f;
+	float count = 0.f;
+	for (int32_t i = 0; i < numChunks; ++i)
+	{
+		maxError = solver.partials[3 * i + 0] > maxError ? solver.partials[3 * i + 0] : maxError;
+		sum += solver.partials[3 * i + 1];
+		count += solver.partials[3 * i + 2];
+	}
+
+	rmsError = count > 0.f ? sqrtf(sum / count) : 0.f;
+}
+
+void dwgSolverEnableStatsHistory(ParticleSolver& solver, int32_t numSteps)
+{
+	solver.statsHistory.assign(numSteps > 0 ? numSteps : 0, SolverStats());
+	solver.statsHistoryHead = 0;
+	solver.statsHistoryCount = 0;
+}
+
+int32_t dwgSolverStatsHistoryCount(const ParticleSolver& solver)
+{
+	return solver.statsHistoryCount;
+}
+
+const SolverStats& dwgSolverStatsHistory(const ParticleSolver& solver, int32_t index)
+{
+	assert(index >= 0 && index < solver.statsHistoryCount);
+
+	// the oldest entry is right after the newest one once the buffer is full
+	const int32_t capacity = (int32_t)solver.statsHistory.size();
+	const int32_t oldest = (solver.statsHistoryHead - solver.statsHistoryCount + capacity) % capacity;
+	return solver.statsHistory[(oldest + index) % capacity];
+}
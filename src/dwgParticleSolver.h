@@ -0,0 +1,302 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include "vectormath.hpp"
+#include "dwgColliderShapes.h"
+
+struct Particle
+{
+	Vector3 pos;
+	Vector3 prevPos;
+	Vector3 vel;
+	float mass = 1.f;	// 0 = static particle, it's used as a weight of the correction
+	Vector3 color = Vector3(-1);
+};
+
+struct ElasticDistance
+{
+	int idx_a = -1;
+	int idx_b = -1;
+
+	float distance = 0.7f;
+	float compliance = 0.005f;
+
+	bool unilateral = false;	// only pulls the particles together when they are farther than distance (tethers)
+
+	// the constrain breaks when it's longer than tearStretch * distance (0 = never, call dwgSolverBuild after changing it), see dwgSolverTear
+	// broken constrains stay in ParticleSolver::constrains, so indices of the others don't change, but nothing solves them
+	float tearStretch = 0.f;
+	bool broken = false;
+};
+
+// group of particles connected by constrains, islands don't affect each other
+// static particles don't connect islands, they don't belong to any
+struct SolverIsland
+{
+	std::vector<int32_t> particles;
+	std::vector<int32_t> constrains;
+
+	float maxError = 0.f;		// biggest constrain error seen in the last iteration (with adaptive iterations)
+	int32_t numIterations = 0;	// iterations the island got during the last step (with adaptive iterations)
+
+	// sleeping, see ParticleSolver::sleeping
+	bool sleeping = false;
+	float kineticEnergy = 0.f;	// 0.5 * |vel|^2 averaged over the particles of the island after the last step
+	float sleepTime = 0.f;		// how long the island has been slow enough to fall asleep
+	Vector3 boundsMin;			// bounds of the particles of a sleeping island
+	Vector3 boundsMax;
+};
+
+// colliders with mass are rigid bodies (solid spheres), the solver integrates them with gravity and particles push and spin them
+// they collide with the static shapes too (with friction), but not with each other
+// colliders without mass are moved only by the app (kinematic)
+struct SphereCollider
+{
+	Vector3 pos;
+	Vector3 prevPos;	// position at the start of the step, set it together with pos when placing the collider
+	float radius = 0.5f;
+	Vector3 color;
+
+	// 0 = particles can't push the collider, otherwise it's the weight of the correction like Particle::mass
+	// so it acts as the inverse mass (bigger = lighter), the inverse inertia is mass / (0.4 * radius^2)
+	float mass = 0.f;
+
+	Quat rotation = Quat::identity();
+	Quat prevRotation = Quat::identity();	// rotation at the start of the step
+	Vector3 vel = Vector3(0.f);
+	Vector3 angularVel = Vector3(0.f);
+
+	// coulomb friction, tangential movement of a particle on the surface is stopped up to friction * penetration
+	// the rest of it slides (and spins a collider with mass)
+	float friction = 0.f;
+};
+
+enum class SolverMode
+{
+	GaussSeidel,	// constrains are resolved one by one, each sees the corrections of the previous ones (single thread)
+	Jacobi,			// every constrain is resolved from the previous iterate, corrections are averaged per particle (multithreaded)
+};
+
+// measurements of a single dwgSolverStep
+struct SolverStats
+{
+	float maxError = 0.f;		// biggest |distance - constrain distance| at the end of the step
+	float rmsError = 0.f;		// root mean square of the constrain errors at the end of the step
+	int32_t numIterations = 0;
+	int32_t numIslandIterations = 0;	// sum of iterations of all islands (less than iterations * islands with adaptive iterations)
+	int32_t numCollisionTests = 0;		// particle vs collider tests that passed the broadphase
+	int32_t numSweptTests = 0;			// particle vs collider tests that were fast enough for continuous collision
+	int32_t numSleepingIslands = 0;
+	int32_t numAwakeParticles = 0;		// particles that were simulated (including static ones)
+	uint64_t stateHash = 0;				// dwgSolverStateHash after the step (with deterministic)
+	int32_t numTornConstrains = 0;
+
+	// time of each phase in milliseconds
+	float integrateTime = 0.f;
+	float constrainsTime = 0.f;
+	float collisionTime = 0.f;
+	float velocityTime = 0.f;
+};
+
+struct ParticleSolver
+{
+	std::vector<Particle> particles;
+	std::vector<ElasticDistance> constrains;
+	std::vector<SphereCollider> colliders;
+
+	// static shapes, see dwgColliderShapes.h (call dwgBuildMeshCollider before adding a mesh)
+	std::vector<CapsuleCollider> capsules;
+	std::vector<BoxCollider> boxes;
+	std::vector<PlaneCollider> planes;
+	std::vector<MeshCollider> meshes;
+
+	Vector3 gravity = Vector3(0.f, 0.f, -9.81f);
+	float particleRadius = 0.2f;
+
+	SolverMode mode = SolverMode::GaussSeidel;
+	int32_t numIterations = 1;
+
+	// jacobi corrections are averaged per particle, relaxation > 1 speeds up the convergence (keep it below 2)
+	float jacobiRelaxation = 1.5f;
+
+	// chebyshev semi-iterative acceleration of the iterations (worth it from about 4 iterations)
+	// positions after each iteration are extrapolated using the estimated spectral radius of the iterations
+	bool chebyshev = false;
+	int32_t chebyshevDelay = 2;		// plain iterations at the start of a step, used to measure the spectral radius
+	float chebyshevRho = 0.9f;		// estimated spectral radius (how fast the plain iterations converge), updated every step
+	int32_t chebyshevRestarts = 0;	// how many times the acceleration diverged and was restarted during the last step
+
+	// adaptive iterations, every island iterates only until its biggest error is below errorTolerance
+	// numIterations is then the maximum, islands that are still violating get more iterations than the quiet ones
+	// iterationTimeBudget caps the time of iterations per frame in milliseconds (0 = no limit), see dwgSolverBeginFrame
+	// chebyshev acceleration is not used with adaptive iterations
+	bool adaptiveIterations = false;
+	float errorTolerance = 0.001f;
+	float iterationTimeBudget = 0.f;
+	float frameIterationTime = 0.f;	// time of iterations used since dwgSolverBeginFrame
+
+	// colliders are put into a uniform grid (stored as a spatial hash) when there are more of them than colliderBroadphaseThreshold
+	// then every particle is tested only against the colliders overlapping its cell (the cells of its path with continuous collision)
+	int32_t colliderBroadphaseThreshold = 8;
+	float colliderCellSize = 0.f;	// 0 = twice the average collider radius + particle radius
+
+	// particles collide with each other (also particles of different cloths), particles connected by a constrain don't
+	// particles are counting sorted into a spatial hash every step, cells are twice the collision distance
+	bool selfCollision = false;
+	float selfCollisionDistance = 0.f;	// 0 = 2 * particleRadius
+
+	// continuous collision, fast colliders are swept from prevPos to pos against particle paths (prevPos to pos)
+	// and the particles are put at the point of impact instead of being pushed out of the collider at the end position
+	// only pairs that moved relative to each other by more than the collision distance pay for it
+	bool continuousCollision = false;
+
+	// islands that stay slower than sleepEnergy for sleepDelay seconds fall asleep
+	// sleeping islands are not integrated, solved nor collided, they only stay in the self collision grid as obstacles
+	// they wake up when a sphere collider or a particle of an awake island touches them (or by dwgSolverWakeIsland)
+	// chebyshev acceleration is not used while some islands sleep
+	bool sleeping = false;
+	float sleepEnergy = 0.001f;	// limit of SolverIsland::kineticEnergy
+	float sleepDelay = 0.5f;
+
+	// results don't depend on the number of threads or on the time a step takes, so replays and lockstep games match bit by bit
+	// parallel loops always use the same chunks and reduce them in chunk order, so this only turns off the iteration
+	// time budget and hashes the state after every step (stats.stateHash)
+	// build with floating point contraction turned off (see CMakeLists.txt), fused multiply-add gives different results
+	bool deterministic = false;
+
+	// islands, created by dwgSolverBuild
+	// when constrains break, only the particles around them are searched to find the part that fell off (at the end of dwgSolverTear)
+	// removing from an island moves its last particle or constrain to the free slot, so the order changes, but the same way every time
+	std::vector<SolverIsland> islands;
+	std::vector<int32_t> particleIsland;	// island of each particle, -1 for static particles
+	std::vector<int32_t> particleIslandSlots;	// index of each particle in SolverIsland::particles
+	std::vector<int32_t> constrainIslandSlots;	// index of each constrain in SolverIsland::constrains, -1 when it's in none
+	std::vector<int32_t> splitConstrains;		// broken two sided constrains, they may have split their island or cut it from a static particle
+	std::vector<int32_t> searchMarks;			// particles visited by the searches of dwgSolverSplitIslands
+	std::vector<int32_t> searchParticles[2];
+	int32_t searchStamp = 0;
+	bool hasTearableConstrains = false;
+
+	// particles that are not in a sleeping island, sorted again when an island falls asleep or wakes up
+	std::vector<int32_t> awakeParticles;
+	bool awakeParticlesDirty = true;
+	int32_t numSleepingIslands = 0;
+
+	// jacobi data, created by dwgSolverBuild
+	// broken constrains are removed from the range of the particle and the refs after them move down, so the range only shrinks
+	std::vector<int32_t> particleConstrainOffsets;	// constrains of particle i are refs [offsets[i], offsets[i] + counts[i])
+	std::vector<int32_t> particleConstrainCounts;
+	std::vector<int32_t> particleConstrainRefs;		// 2 * constrain index + 0 for idx_a or + 1 for idx_b
+	std::vector<Vector3> constrainCorrections;		// 2 per constrain, written by constrains and gathered by particles
+	std::vector<uint8_t> constrainActive;			// 1 when the constrain corrected this iteration (not slack, broken or static)
+
+	// chebyshev data, positions of the current and the previous iterate
+	std::vector<Vector3> chebyshevIterPos;
+	std::vector<Vector3> chebyshevPrevPos;
+
+	// collider broadphase data, rebuilt every step
+	std::vector<int32_t> colliderBuckets;		// colliders of hash bucket b are entries [buckets[b], buckets[b + 1])
+	std::vector<int32_t> colliderEntries;
+	std::vector<int32_t> colliderLarge;			// colliders covering too many cells or with mass, tested against every particle
+	std::vector<int32_t> colliderStamp;			// last particle tested against each collider, so a collider isn't tested twice
+	std::vector<int32_t> colliderCandidates;		// colliders of the cells crossed by a particle (continuous collision)
+
+	// self collision data, rebuilt every step
+	std::vector<uint32_t> particleBucket;			// hash bucket of every particle
+	std::vector<int32_t> particleBucketCounts;		// particles of each sort chunk in each bucket
+	std::vector<int32_t> particleBuckets;			// particles of hash bucket b are sortedParticles [buckets[b], buckets[b + 1])
+	std::vector<int32_t> sortedParticles;
+	std::vector<Vector3> selfCollisionCorrections;
+	std::vector<int32_t> selfCollisionWakes;		// sleeping island touched by each awake particle, -1 for none
+
+	// adaptive iterations data
+	std::vector<int32_t> activeIslands;
+	std::vector<int32_t> activeConstrains;
+	std::vector<int32_t> activeParticles;
+	std::vector<float> constrainErrors;
+
+	std::vector<float> partials;	// results of parallel chunks, reduced in chunk order
+
+	// stats of the last step, measuring the errors costs one pass over the constrains
+	SolverStats stats;
+	bool measureError = true;
+
+	// ring buffer of stats of the previous steps, see dwgSolverEnableStatsHistory
+	std::vector<SolverStats> statsHistory;
+	int32_t statsHistoryHead = 0;
+	int32_t statsHistoryCount = 0;
+};
+
+// call after adding particles and constrains, and after every change of the constrains
+void dwgSolverBuild(ParticleSolver& solver);
+
+// adds a distance constrain over every two constrains that continue each other almost in a straight line (a - p - b)
+// that's a skip one constrain along the chains and across them, it keeps the cloth from folding at a single particle
+// call it once after adding the stretch constrains, then call dwgSolverBuild
+void dwgSolverAddBendingConstrains(ParticleSolver& solver, float compliance);
+
+// adds a unilateral constrain from every dynamic particle to its closest static particle (long range attachment)
+// the distance is the length of the shortest path through the constrains, so the constrain is slack until the cloth is stretched
+// it stops the sagging that many iterations would be needed for otherwise, call it after the other constrains, then call dwgSolverBuild
+void dwgSolverAddTethers(ParticleSolver& solver, float compliance);
+
+// breaks the constrain, removes it from the particles and from its island, and wakes up the island
+// the island is split at the end of the next dwgSolverTear (or call dwgSolverSplitIslands)
+void dwgSolverBreakConstrain(ParticleSolver& solver, int32_t constrain);
+
+// splits the islands that lost a constrain into connected parts, the new parts are added to the end of the islands
+// a tether stays only while its static particle is connected to the part by a two sided constrain, otherwise it would hold the part in the air
+void dwgSolverSplitIslands(ParticleSolver& solver);
+
+// breaks the constrains that are stretched more than their tearStretch, then splits the islands
+void dwgSolverTear(ParticleSolver& solver);
+
+// call at the beginning of every frame, resets the iteration time budget
+void dwgSolverBeginFrame(ParticleSolver& solver);
+
+// one fixed step of the simulation: integrate, constrains, collision and velocity update, fills solver.stats
+void dwgSolverStep(ParticleSolver& solver, float dt);
+
+// saves prevPos and moves dynamic particles and colliders with mass by velocity and acceleration
+// wakes up sleeping islands touched by sphere colliders first
+void dwgSolverIntegrate(ParticleSolver& solver, const Vector3& acceleration, float dt);
+
+// resolves elastic distance constrains numIterations times using the solver mode (and chebyshev acceleration if enabled)
+void dwgSolverConstrains(ParticleSolver& solver, float dt);
+
+// wakes up a sleeping island, it's simulated again from the next phase of the step
+void dwgSolverWakeIsland(ParticleSolver& solver, int32_t island);
+
+// pushes particles out of each other (with selfCollision)
+void dwgSolverSelfCollisions(ParticleSolver& solver);
+
+// pushes particles out of the colliders (and colliders with mass out of the particles) with friction
+// then out of the static shapes
+void dwgSolverCollisions(ParticleSolver& solver);
+
+// calculates velocity from the movement during the step (including constrains and collision)
+// also of colliders with mass, then sets prevPos and prevRotation of all colliders, the next step sweeps them from there
+void dwgSolverUpdateVelocities(ParticleSolver& solver, float dt);
+
+// measures kinetic energy of the awake islands and puts the slow ones to sleep (with sleeping)
+void dwgSolverUpdateSleeping(ParticleSolver& solver, float dt);
+
+// FNV-1a hash (of 32 bit words) of positions and velocities of the particles and positions of the sphere colliders
+uint64_t dwgSolverStateHash(const ParticleSolver& solver);
+
+// positions for rendering between the last two steps, lerp(prevPos, pos, alpha) (alpha from FixedTimestep)
+// rendering is then up to one step behind the simulation, but moves smoothly when steps and frames don't line up
+void dwgSolverInterpolate(const ParticleSolver& solver, float alpha, std::vector<Vector3>& positions);
+
+// biggest and root mean square error of all elastic distance constrains
+void dwgSolverMeasureError(ParticleSolver& solver, float& maxError, float& rmsError);
+
+// keeps the stats of the last numSteps steps, 0 turns the history off
+void dwgSolverEnableStatsHistory(ParticleSolver& solver, int32_t numSteps);
+
+// number of steps in the history
+int32_t dwgSolverStatsHistoryCount(const ParticleSolver& solver);
+
+// stats of a step from the history, 0 is the oldest one
+const SolverStats& dwgSolverStatsHistory(const ParticleSolver& solver, int32_t index);
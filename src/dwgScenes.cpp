@@ -0,0 +1,304 @@
+#include "dwgScenes.h"
+#include <math.h>
+
+int32_t dwgBuildClothScene(ParticleSolver& solver, int32_t numChains, int32_t numParticles)
+{
+	const float radius = 0.2f;
+
+	struct Cloth
+	{
+		Vector3 origin = Vector3(3.5f, -3.f, 2.5f);
+		Vector3 spacing;
+	};
+
+	const int numCloths = 3;
+	Cloth cloths[numCloths];
+
+	cloths[0].spacing = Vector3(0.f, 0.f, -radius * 2.5f);
+
+	cloths[1].spacing = Vector3(0.f, 0.f, -radius * 2.5f);
+	cloths[1].origin.setX(-cloths[1].origin.getX() + (radius * numChains * 2.f));
+	cloths[1].origin.setY(-cloths[1].origin.getX());
+
+	cloths[2].origin = Vector3(1.5f, -1.5f, -1.f);
+	cloths[2].spacing = Vector3(-radius * 2.5f, -radius * 2.5f, 0.f);
+
+	// all particles and constrains of all cloths live in one solver
+	// particle j of chain i of cloth k has index (k * numChains + i) * numParticles + j
+	solver = ParticleSolver();
+	solver.mode = SolverMode::GaussSeidel;
+	//solver.mode = SolverMode::Jacobi;
+
+	auto particleIndex = [&](int cloth, int chain, int particle)
+	{
+		return (cloth * numChains + chain) * numParticles + particle;
+	};
+
+	// chain 0 - red
+	// chain 1 - green
+	// chain 2 - blue
+
+	// make particles for each chain
+	for (int k = 0; k < numCloths; ++k)
+	{
+		Cloth& cl = cloths[k];
+		Vector3 chainOrigin = cl.origin;
+
+		for (int i = 0; i < numChains; ++i)
+		{
+			const Vector3 chainColor = i % 3 == 0 ? Vector3(1.f, 0.3f, 0.5f) : i % 3 == 1 ? Vector3(0.1f, 0.9f, 0.5f) : Vector3(0.3f, 0.3f, 1.f);
+
+			Vector3 pos = chainOrigin;
+			chainOrigin += {-radius * 2.f, radius * 2.f, 0.f};
+
+			for (int j = 0; j < numParticles; ++j)
+			{
+				Particle p;
+				p.pos = pos;
+				p.prevPos = pos;
+				p.vel = Vector3(0.f);
+				pos += cl.spacing;
+
+				// first particle (and the last one in the other cloths) is pinned
+				if (j == 0 || (k > 0 && j == numParticles - 1))
+				{
+					p.mass = 0.f;
+				}
+
+				// static particles are drawn in the color of their chain
+				p.color = p.mass ? Vector3(1.f) : chainColor;
+
+				solver.particles.push_back(p);
+			}
+		}
+	}
+
+	// vertical constrains, along each chain
+	for (int k = 0; k < numCloths; ++k)
+	{
+		for (int i = 0; i < numChains; ++i)
+		{
+			for (int j = 0; j < numParticles - 1; ++j)
+			{
+				ElasticDistance c;
+
+				c.idx_a = particleIndex(k, i, j);
+				c.idx_b = particleIndex(k, i, j + 1);
+
+				// this will be the same for every particle because all of the have equal distances between adjacent particles
+				c.distance = length(solver.particles[c.idx_a].pos - solver.particles[c.idx_b].pos);
+
+				solver.constrains.push_back(c);
+			}
+		}
+	}
+
+	// horizontal constrains, between the same particles of neighbouring chains
+	for (int k = 0; k < numCloths; ++k)
+	{
+		for (int i = 0; i < numChains - 1; ++i)
+		{
+			for (int j = 0; j < numParticles; ++j)
+			{
+				ElasticDistance c;
+
+				c.idx_a = particleIndex(k, i, j);
+				c.idx_b = particleIndex(k, i + 1, j);
+
+				c.distance = length(solver.particles[c.idx_a].pos - solver.particles[c.idx_b].pos);
+
+				solver.constrains.push_back(c);
+			}
+		}
+	}
+
+	// only the stretch constrains are drawn
+	const int32_t numStretchConstrains = (int32_t)solver.constrains.size();
+
+	// softer skip one constrains keep the cloth from folding at single particles
+	// and tethers to the static particles stop the sagging, so the cloth stays stiff with few iterations
+	dwgSolverAddBendingConstrains(solver, 0.05f);
+
+	// cloth tears where a collider stretches it to 2.5 times its length
+	for (ElasticDistance& c : solver.constrains)
+	{
+		c.tearStretch = 2.5f;
+	}
+
+	dwgSolverAddTethers(solver, 0.f);
+
+	dwgSolverBuild(solver);
+
+
+	// Setup colliders / spheres
+	const int numColiders = 4;
+
+	solver.colliders.resize(numColiders);
+	std::vector<SphereCollider>& colliders = solver.colliders;
+
+	colliders[0].pos = Vector3(0.f, 0.f, 0.5f);
+	colliders[0].color = Vector3(0.5f, 1.0f, 0.5f);
+
+	colliders[1].pos = Vector3(0.f, 2.f, 0.2f);
+	colliders[1].color = Vector3(1.f, 0.5f, 0.5f);
+
+	colliders[2].pos = Vector3(-2.5f, -2.f, 3.f);
+	colliders[2].color = Vector3(1.f, 0.2f, 0.3f);
+	colliders[2].mass = 1.f;
+
+	colliders[3].pos = Vector3(-2.f, -4.f, 3.f);
+	colliders[3].color = Vector3(0.5f, 0.2f, 0.8f);
+	colliders[3].mass = 1.f;
+
+	// colliders 2 and 3 have mass, so they are rigid bodies that fall on the cloths, roll and spin
+	// the kinematic ones start where the animation starts, so the first step doesn't sweep them through the cloths
+	dwgAnimateClothScene(solver, 0.0);
+	for (SphereCollider& col : colliders)
+	{
+		col.prevPos = col.pos;
+		col.friction = 0.5f;
+	}
+
+	// static shapes: the ground under the bottom row of the first cloth, a capsule pressing into it, a box under the third cloth
+	// and a pyramid mesh under the first one, its bottom row drapes over it
+	PlaneCollider ground;
+	ground.normal = Vector3(0.f, 0.f, 1.f);
+	ground.offset = -3.1f;
+	solver.planes.push_back(ground);
+
+	CapsuleCollider capsule;
+	capsule.a = Vector3(3.6f, -2.9f, -1.8f);
+	capsule.b = Vector3(0.8f, -0.1f, -1.8f);
+	capsule.radius = 0.3f;
+	capsule.color = Vector3(0.9f, 0.7f, 0.2f);
+	solver.capsules.push_back(capsule);
+
+	BoxCollider box;
+	box.pos = Vector3(-2.6f, -2.8f, -2.2f);
+	box.rotation = Quat::rotationZ(0.7853982f);	// 45 degrees
+	box.halfExtents = Vector3(0.8f, 0.8f, 0.5f);
+	box.color = Vector3(0.2f, 0.7f, 0.9f);
+	solver.boxes.push_back(box);
+
+	MeshCollider pyramid;
+	const Vector3 base(2.1f, -1.6f, -3.1f);
+	pyramid.vertices = { base + Vector3(-0.6f, -0.6f, 0.f), base + Vector3(0.6f, -0.6f, 0.f), base + Vector3(0.6f, 0.6f, 0.f), base + Vector3(-0.6f, 0.6f, 0.f), base + Vector3(0.f, 0.f, 0.9f) };
+	pyramid.indices = { 0, 1, 4, 1, 2, 4, 2, 3, 4, 3, 0, 4, 0, 2, 1, 0, 3, 2 };
+	dwgBuildMeshCollider(pyramid);
+	solver.meshes.push_back(pyramid);
+
+	solver.particleRadius = radius;
+
+	// cloths collide with themselves and with each other
+	solver.selfCollision = true;
+
+	// moving colliders can't tunnel through particles when a frame takes longer
+	solver.continuousCollision = true;
+
+	// cloths that stop swinging fall asleep until a collider touches them
+	// the swinging colliders keep them awake, the --still option of the headless runner holds the colliders to show it
+	solver.sleeping = true;
+
+
+	// gravitation
+	Vector3 acceleration = { 0.f, 0.f, -9.81f };
+	//Vector3 acceleration = { 0.f, 0.f, 0.f };
+	solver.gravity = acceleration;
+
+	// 1 iteration = 1 time calculating constrains and collision
+	// more iteration = more precise/accurate simulation
+	// iteration reduces the stiffness/compliance impact
+	// every cloth iterates until its biggest error is below 5cm, a tenth of the particle spacing (8 times at most, 4ms per frame at most)
+	// the colliders keep pushing the cloths, so a smaller tolerance is never reached and every cloth would always get all 8
+	// with this one a cloth is done after one or two iterations in most steps, the ones pushed hard get more
+	solver.adaptiveIterations = true;
+	solver.numIterations = 8;
+	solver.errorTolerance = 0.05f;
+	solver.iterationTimeBudget = 4.f;
+
+	// errors and timings of the last 10 seconds of steps, see dwgSolverStatsHistory
+	dwgSolverEnableStatsHistory(solver, 600);
+
+	// chebyshev acceleration needs a few iterations, then it gets about the same error with half of them
+	//solver.adaptiveIterations = false;
+	//solver.numIterations = 4;
+	//solver.chebyshev = true;
+
+	return numStretchConstrains;
+}
+
+void dwgAnimateClothScene(ParticleSolver& solver, double time)
+{
+	std::vector<SphereCollider>& colliders = solver.colliders;
+
+	colliders[0].pos.setY(sinf(time) * 2.5f - 1.5f);
+	colliders[0].pos.setX(colliders[0].pos.getY() / 2.f + 3.f);
+
+	colliders[1].pos.setY(-sinf(time) * 2.5f + 2.f);
+	colliders[1].pos.setX(colliders[1].pos.getY() - 3.f);
+}
+
+void dwgBuildChainScene(ParticleSolver& solver)
+{
+	solver = ParticleSolver();
+
+	const int numParticles = 10;
+
+	Vector3 origin = { 0.f, 0.f, 1.f };
+
+	float radius = 0.2f;
+	solver.particleRadius = radius;
+
+	for (int i = 0; i < numParticles; ++i)
+	{
+		Particle p;
+		p.pos = origin;
+		p.prevPos = origin;
+		origin += Vector3(2.f * radius, 0.f, 0.f);
+		p.vel = Vector3(0.f);
+
+		solver.particles.push_back(p);
+	}
+
+	solver.particles[0].mass = 0.f;
+
+	const int numConstrains = numParticles - 1;
+
+	for (int i = 0; i < numConstrains; ++i)
+	{
+		ElasticDistance c;
+
+		c.idx_a = i;
+		c.idx_b = i + 1;
+
+		c.distance = length(solver.particles[i].pos - solver.particles[i + 1].pos);
+		c.compliance = 0.05f;
+
+		solver.constrains.push_back(c);
+	}
+
+	dwgSolverBuild(solver);
+
+	solver.colliders.resize(1);
+	SphereCollider& collider = solver.colliders[0];
+	collider.pos = Vector3(0.f, 2.f, 0.f);
+	dwgAnimateChainScene(solver, 0.0);	// the first step starts where the animation starts
+	collider.prevPos = collider.pos;
+	collider.color = Vector3(0.5f, 1.0f, 0.5f);
+
+	// gravitation
+	solver.gravity = { 0.f, 0.f, -9.81f };
+
+	// 1 iteration = 1 time calculating constrains and collision
+	// more iteration = more precise/accurate simulation
+	// iteration reduces the stiffness/compliance impact
+	solver.numIterations = 1;
+
+	// errors and timings of the last 10 seconds of steps, see dwgSolverStatsHistory
+	dwgSolverEnableStatsHistory(solver, 600);
+}
+
+void dwgAnimateChainScene(ParticleSolver& solver, double time)
+{
+	solver.colliders[0].pos = { 0.f, sinf(time) * 2.f, 0.f };
+}
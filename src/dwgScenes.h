@@ -0,0 +1,20 @@
+#pragma once
+
+#include "dwgParticleSolver.h"
+
+// scenes of the simulations, shared by the apps (that draw them) and the headless runner (that only steps them)
+
+// cloths made of numChains chains of numParticles particles (8 x 12 in ClothSimulation)
+// two kinematic colliders swing through them, two rigid body colliders fall on them
+// static shapes (ground plane, capsule, box and a pyramid mesh) are under them
+// returns the number of stretch constrains, they are at the start of solver.constrains (bending constrains and tethers follow)
+int32_t dwgBuildClothScene(ParticleSolver& solver, int32_t numChains = 8, int32_t numParticles = 12);
+
+// moves the kinematic colliders of the cloth scene to their positions at the time (in seconds)
+void dwgAnimateClothScene(ParticleSolver& solver, double time);
+
+// single chain hanging from its first particle, a kinematic collider swings through it
+void dwgBuildChainScene(ParticleSolver& solver);
+
+// moves the collider of the chain scene to its position at the time (in seconds)
+void dwgAnimateChainScene(ParticleSolver& solver, double time);
@@ -1,11 +1,40 @@
 #include "dwgSimpleGraphics.h"
+#include "dwgDebugPrimitives.h"
+#include "dwgSoftwareRenderer.h"
 #include <stdlib.h>
 #include <stdio.h>
-#include "glad/glad.h"
-#include "glfw3.h"
 #include "vectormath.hpp"
 #include <cassert>
 #include <string.h>
+#include <stddef.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#if VECTORMATH_MODE_SSE
+#include <emmintrin.h>
+
+static inline __m128 dwgDot4(__m128 ax, __m128 ay, __m128 az, __m128 bx, __m128 by, __m128 bz)
+{
+	return _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(ay, by)), _mm_mul_ps(az, bz));
+}
+#endif
+
+// DWG_NO_GL=1 builds only the software renderer, without OpenGL and glfw (e.g. the headless runner on servers)
+#ifndef DWG_NO_GL
+#define DWG_NO_GL 0
+#endif
+
+#if DWG_NO_GL
+typedef unsigned int GLuint;
+typedef struct __GLsync* GLsync;
+struct GLFWwindow;
+#else
+#include "glad/glad.h"
+#include "glfw3.h"
 
 // vertex shader code
 static const char* vertex_shader_text =
@@ -30,6 +59,91 @@ static const char* fragment_shader_text =
 "    gl_FragColor = vec4(color, 1.0);\n"
 "}\n";
 
+// sphere vertex shader, position, rotation, scale and color are per instance attributes
+// (instanced arrays, or constant attributes set per sphere when instancing is not available)
+static const char* sphere_vertex_shader_text =
+"#version 110\n"
+"uniform mat4 MVP;\n"
+"attribute vec3 vCol;\n"
+"attribute vec3 vPos;\n"
+"attribute vec3 iPosition;\n"
+"attribute vec3 iScale;\n"
+"attribute vec4 iRotation;\n"
+"attribute vec4 iColor;\n"
+"varying vec3 color;\n"
+"void main()\n"
+"{\n"
+"    vec4 q = normalize(iRotation);\n"
+"    vec3 v = vPos * iScale;\n"
+"    v += 2.0 * cross(q.xyz, cross(q.xyz, v) + q.w * v);\n"
+"    gl_Position = MVP * vec4(v + iPosition, 1.0);\n"
+"    color = vCol * iColor.rgb;\n"
+"}\n";
+
+// impostor sphere, the quad faces the eye and covers the outline of the bounding sphere
+// the ray through the pixel is intersected with the unit sphere in the local space of the instance (ellipsoid in the world)
+static const char* impostor_vertex_shader_text =
+"#version 110\n"
+"uniform mat4 MVP;\n"
+"uniform vec3 eye;\n"
+"attribute vec3 vPos;\n"
+"attribute vec3 iPosition;\n"
+"attribute vec3 iScale;\n"
+"attribute vec4 iRotation;\n"
+"attribute vec4 iColor;\n"
+"varying vec3 rayOrigin;\n"
+"varying vec3 rayDirection;\n"
+"varying vec3 worldRay;\n"
+"varying vec3 color;\n"
+"vec3 rotateInverse(vec4 q, vec3 v)\n"
+"{\n"
+"    return v - 2.0 * cross(q.xyz, q.w * v - cross(q.xyz, v));\n"
+"}\n"
+"void main()\n"
+"{\n"
+"    vec3 toEye = eye - iPosition;\n"
+"    float d = length(toEye);\n"
+"    float r = max(max(abs(iScale.x), abs(iScale.y)), abs(iScale.z));\n"
+"    vec3 forward = toEye / d;\n"
+"    vec3 right = normalize(cross(abs(forward.z) < 0.999 ? vec3(0.0, 0.0, 1.0) : vec3(1.0, 0.0, 0.0), forward));\n"
+"    vec3 up = cross(forward, right);\n"
+"    float size = r * d / sqrt(max(d * d - r * r, 1e-6));\n"
+"    vec3 world = iPosition + (right * vPos.x + up * vPos.y) * size;\n"
+"    gl_Position = MVP * vec4(world, 1.0);\n"
+"    vec4 q = normalize(iRotation);\n"
+"    rayOrigin = rotateInverse(q, toEye) / iScale;\n"
+"    rayDirection = rotateInverse(q, world - eye) / iScale;\n"
+"    worldRay = world - eye;\n"
+"    color = iColor.rgb;\n"
+"}\n";
+
+// exact depth and the same fake light as the vertex colors of the sphere meshes
+static const char* impostor_fragment_shader_text =
+"#version 110\n"
+"uniform mat4 MVP;\n"
+"uniform vec3 eye;\n"
+"varying vec3 rayOrigin;\n"
+"varying vec3 rayDirection;\n"
+"varying vec3 worldRay;\n"
+"varying vec3 color;\n"
+"void main()\n"
+"{\n"
+"    float a = dot(rayDirection, rayDirection);\n"
+"    float b = dot(rayOrigin, rayDirection);\n"
+"    float c = dot(rayOrigin, rayOrigin) - 1.0;\n"
+"    float discriminant = b * b - a * c;\n"
+"    if (discriminant < 0.0)\n"
+"        discard;\n"
+"    float t = (-b - sqrt(discriminant)) / a;\n"
+"    if (t < 0.0)\n"
+"        discard;\n"
+"    vec3 normal = rayOrigin + t * rayDirection;\n"
+"    vec4 clip = MVP * vec4(eye + t * worldRay, 1.0);\n"
+"    gl_FragDepth = clip.z / clip.w * 0.5 + 0.5;\n"
+"    float intensity = clamp(dot(normal, vec3(1.0)), 0.0, 1.0);\n"
+"    gl_FragColor = vec4(color * (0.2 + 0.8 * intensity), 1.0);\n"
+"}\n";
+
 static void error_callback(int error, const char* description)
 {
 	fprintf(stderr, "Error: %s\n", description);
@@ -40,28 +154,133 @@ static void key_callback(GLFWwindow* window, int key, int scancode, int action,
 	if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
 		glfwSetWindowShouldClose(window, GLFW_TRUE);
 }
+#endif
+
+// debug primitives are stored in chunks, new chunks are added when needed and existing data never moves
+#define DWG_LINE_CHUNK_VERTICES 16384	// one vertex buffer, one draw call
+#define DWG_SPHERE_CHUNK_SPHERES 8192	// spheres recorded to one chunk, also the initial size of the instance buffer
+#define DWG_STREAM_FRAMES 3	// frames the GPU can be behind before the CPU waits for it
+#define DWG_LINE_CULL_BLOCK_VERTICES 512	// lines are frustum culled by blocks of 256, bounds of every block are kept while recording
+#define DWG_LINE_CULL_BLOCKS (DWG_LINE_CHUNK_VERTICES / DWG_LINE_CULL_BLOCK_VERTICES)
 
-#define DWG_MAX_DEBUG_VERTICES 16384
-#define DWG_MAX_DEBUG_SPHERES 8192
+#define DWG_NEAR_PLANE 0.1f
+#define DWG_FAR_PLANE 1000.0f
+
+// smallest projected radius (pixels) of the sphere LODs, smaller spheres use the next one
+// 1140 triangles (stacks and sectors), 320, 80 and 20 (icospheres), the outline is off by less than a pixel
+static const float s_sphereLodRadii[DWG_SPHERE_LODS - 1] = { 48.0f, 16.0f, 5.0f };
 
 #define DWG_MAX(_x, _y) _x > _y ? _x : _y;
 #define DWG_MIN(_x, _y) _x < _y ? _x : _y;
 
-struct DebugVertex
+// vertex buffer written by the CPU every frame, the debug functions write directly into the mapped memory
+// with persistent mapping (GL 4.4) the buffer is a ring of DWG_STREAM_FRAMES regions, guarded by fences
+// otherwise the buffer is orphaned and mapped again every frame
+struct DebugStreamBuffer
+{
+	GLuint buffer = 0;
+	int32_t regionSize = 0;	// bytes
+	int32_t region = 0;	// region written this frame
+	uint8_t* persistent = nullptr;	// whole buffer, null when orphaning
+	GLsync fences[DWG_STREAM_FRAMES] = {};
+
+	uint8_t* mapped = nullptr;	// memory of this frame
+};
+
+struct DebugLineChunk
+{
+	DebugStreamBuffer stream;	// no buffer for overflow chunks and in the software mode
+	DebugVertex* vertices = nullptr;	// mapped memory, or CPU memory of overflow chunk
+	int32_t numVertices = 0;
+	bool overflow = false;	// owned by the recorder, not by the pool
+	float blockMin[DWG_LINE_CULL_BLOCKS][3];	// world space bounds of the blocks, valid up to numVertices
+	float blockMax[DWG_LINE_CULL_BLOCKS][3];
+
+	intptr_t drawOffset = 0;	// offset of this frame's data in the buffer
+	DebugLineChunk* uploaded = nullptr;	// chunk that got the data of overflow chunk
+};
+
+struct DebugSphereChunk
+{
+	DebugSphere spheres[DWG_SPHERE_CHUNK_SPHERES];
+	int32_t numSpheres = 0;
+};
+
+// consecutive primitives recorded with the same sort key
+struct DebugLineSegment
+{
+	int32_t key;
+	DebugLineChunk* chunk;
+	int32_t first;	// vertex in the chunk
+	int32_t count;
+};
+
+// visible part of the line segments, drawn by one call
+struct DebugLineRange
+{
+	DebugLineChunk* chunk;
+	int32_t first;
+	int32_t count;
+};
+
+struct DebugSphereSegment
+{
+	int32_t key;
+	const DebugSphere* spheres;
+	int32_t count;
+};
+
+// every thread records to its own context, so the debug functions don't need locks
+// line chunks come from the shared pool mapped before the frame (atomic counter), when the pool runs out
+// the render thread maps new ones and other threads record to overflow chunks in CPU memory, uploaded by dwgRender
+struct DebugRecorder
 {
-	float x, y, z;
-	float r, g, b;
+	std::vector<DebugLineChunk*> lineChunks;	// chunks of this frame
+	std::vector<DebugLineChunk*> spareLineChunks;	// overflow chunks of previous frames
+	std::vector<DebugLineSegment> lineSegments;
+	DebugLineChunk* lineChunk = nullptr;
+
+	std::vector<DebugSphereChunk*> sphereChunks;	// kept between frames
+	int32_t numSphereChunks = 0;	// used this frame
+	std::vector<DebugSphereSegment> sphereSegments;
+	DebugSphereChunk* sphereChunk = nullptr;
+
+	int32_t sortKey = 0;
+
+	~DebugRecorder();
 };
 
-struct DebugSphere
+// a recorder that started recording since the last dwgRender, threads push them to a lock free list
+struct DebugRecorderLink
 {
-	Matrix4 worldLocation;
-	Vector3 color;
+	std::shared_ptr<DebugRecorder> recorder;
+	DebugRecorderLink* next = nullptr;
 };
 
 struct DwGSimpleGraphics
 {
 	GLFWwindow* window = nullptr;
+	uint32_t flags = 0;
+	int32_t width = 0;
+	int32_t height = 0;
+
+	// CPU rasterizer instead of OpenGL, no window (DWG_APP_SOFTWARE or DWG_NO_GL builds)
+	bool software = false;
+	SoftwareRenderer softwareRenderer;
+	std::chrono::steady_clock::time_point startTime;	// the software mode has no glfw timer
+
+	// headless rendering target
+	GLuint framebuffer = 0;
+	GLuint colorRenderbuffer = 0;
+	GLuint depthRenderbuffer = 0;
+
+	// frame capture, frames are read to pixel buffers and mapped DWG_STREAM_FRAMES frames later, so the read back doesn't stall
+	GLuint captureBuffers[DWG_STREAM_FRAMES] = {};
+	GLsync captureFences[DWG_STREAM_FRAMES] = {};
+	int32_t captureWidths[DWG_STREAM_FRAMES] = {};	// 0 when the buffer has no frame
+	int32_t captureHeights[DWG_STREAM_FRAMES] = {};
+	int32_t captureSlot = 0;
+	std::vector<uint8_t> capturePixels;	// synchronous read back without pixel buffers
 	
 	// graphics pipeline
 	GLuint vertexShader = 0;
@@ -72,23 +291,61 @@ struct DwGSimpleGraphics
 	GLuint vertexShaderColorLoc = 0;
 	GLuint vertexShaderTintLoc = 0;
 
-	// debug lines
-	DebugVertex* dataLines = nullptr;
-	int32_t numDataLines = 0;
-	GLuint vertexBufferLines = 0;
+	// sphere pipeline
+	GLuint sphereVertexShader = 0;
+	GLuint sphereShaderProgram = 0;
+	GLuint sphereShaderMVPLoc = 0;
+	GLuint sphereShaderPositionLoc = 0;
+	GLuint sphereShaderColorLoc = 0;
+	GLuint sphereShaderInstancePositionLoc = 0;
+	GLuint sphereShaderInstanceScaleLoc = 0;
+	GLuint sphereShaderInstanceRotationLoc = 0;
+	GLuint sphereShaderInstanceColorLoc = 0;
+
+	// impostor sphere pipeline
+	GLuint impostorVertexShader = 0;
+	GLuint impostorFragmentShader = 0;
+	GLuint impostorShaderProgram = 0;
+	GLuint impostorShaderMVPLoc = 0;
+	GLuint impostorShaderEyeLoc = 0;
+	GLuint impostorShaderPositionLoc = 0;
+	GLuint impostorShaderInstancePositionLoc = 0;
+	GLuint impostorShaderInstanceScaleLoc = 0;
+	GLuint impostorShaderInstanceRotationLoc = 0;
+	GLuint impostorShaderInstanceColorLoc = 0;
+	bool instancing = false;	// GL 3.3 instanced arrays, otherwise one draw per sphere with constant attributes
+
+	// recording
+	std::thread::id renderThread;	// the one that called dwgInitApp
+	std::atomic<DebugRecorderLink*> newRecorders{ nullptr };	// pushed by threads on their first record, taken by dwgRender
+	std::vector<std::shared_ptr<DebugRecorder>> recorders;	// render thread only, also owned by their threads, see dwgRecorder
+	bool stableOrder = false;
+
+	// debug lines, chunks are kept between frames
+	std::vector<DebugLineChunk*> lineChunks;
+	std::vector<DebugLineChunk*> readyLineChunks;	// mapped before the frame, taken by any thread
+	std::atomic<int32_t> nextReadyLineChunk{ 0 };
+	int32_t nextFreeLineChunk = 0;	// lineChunks after the ready ones are mapped by the render thread when needed
+
+	std::vector<DebugLineChunk*> drawLineChunks;
+	std::vector<DebugLineSegment> drawLineSegments;
+	std::vector<DebugLineRange> drawLineRanges;	// after the frustum culling
 
 	// debug spheres
-	DebugVertex* dataSphereMesh = nullptr;
-	int32_t numDataSphereVertices = 0;
-	
-	uint16_t* sphereIndices = nullptr;
-	int32_t numSphereIndices = 0;
+	std::vector<DebugVertex> sphereVertices;	// all LODs
+	std::vector<uint16_t> sphereIndices;
+	DebugSphereLod sphereLods[DWG_SPHERE_LODS + 1];	// + the impostor quad
 
 	GLuint vertexBufferSphereMesh = 0;
 	GLuint indexBufferSphereMesh = 0;
+	GLuint instanceBufferSpheres = 0;
 
-	DebugSphere* spheres = nullptr;
-	int32_t numSpheres = 0;
+	std::vector<DebugSphereSegment> drawSphereSegments;
+	std::vector<DebugSphere> lodSpheres[DWG_SPHERE_LODS + 1];	// spheres of this frame by the LOD (or impostors), in the order of the segments
+	bool impostors = false;
+	bool culling = true;
+
+	DwGDebugStats stats;
 
 	// time
 	double globalTime = 0.0f;
@@ -97,360 +354,1687 @@ struct DwGSimpleGraphics
 
 DwGSimpleGraphics g_dwg;
 
-bool dwgInitApp(int32_t width, int32_t height, const char* title)
+#if !DWG_NO_GL
+static void dwgStreamInit(DebugStreamBuffer& stream, int32_t regionSize)
 {
-	// init window
-	{
-		glfwSetErrorCallback(error_callback);
-
-		if (!glfwInit())
-			return false;
-
-		glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 2);
-		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 0);
+	stream.regionSize = regionSize;
 
-		g_dwg.window = glfwCreateWindow(1600, 900, "DwG - Game Math", NULL, NULL);
-		if (!g_dwg.window)
-		{
-			glfwTerminate();
-			return false;
-		}
+	glGenBuffers(1, &stream.buffer);
+	glBindBuffer(GL_ARRAY_BUFFER, stream.buffer);
 
-		glfwSetKeyCallback(g_dwg.window, key_callback);
-	}
-	
-	// init OpenGL
+	if (GLAD_GL_VERSION_4_4)
 	{
-		glfwMakeContextCurrent(g_dwg.window);
-		gladLoadGL();
-		glfwSwapInterval(1);
+		const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(GL_ARRAY_BUFFER, regionSize * DWG_STREAM_FRAMES, NULL, flags);
+		stream.persistent = (uint8_t*)glMapBufferRange(GL_ARRAY_BUFFER, 0, regionSize * DWG_STREAM_FRAMES, flags);
 	}
-	
-	// init rendering
+	else
 	{
-		g_dwg.vertexShader = glCreateShader(GL_VERTEX_SHADER);
-		glShaderSource(g_dwg.vertexShader, 1, &vertex_shader_text, NULL);
-		glCompileShader(g_dwg.vertexShader);
+		glBufferData(GL_ARRAY_BUFFER, regionSize, NULL, GL_STREAM_DRAW);
+	}
+}
 
-		g_dwg.fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-		glShaderSource(g_dwg.fragmentShader, 1, &fragment_shader_text, NULL);
-		glCompileShader(g_dwg.fragmentShader);
+// maps the memory for the next frame
+static void dwgStreamBegin(DebugStreamBuffer& stream)
+{
+	// not used since the last begin
+	if (stream.mapped)
+		return;
 
-		g_dwg.shaderProgram = glCreateProgram();
-		glAttachShader(g_dwg.shaderProgram, g_dwg.vertexShader);
-		glAttachShader(g_dwg.shaderProgram, g_dwg.fragmentShader);
-		glLinkProgram(g_dwg.shaderProgram);
+	if (stream.persistent)
+	{
+		stream.region = (stream.region + 1) % DWG_STREAM_FRAMES;
 
-		g_dwg.vertexShaderMVPLoc = glGetUniformLocation(g_dwg.shaderProgram, "MVP");
-		g_dwg.vertexShaderTintLoc = glGetUniformLocation(g_dwg.shaderProgram, "tint");
-		g_dwg.vertexShaderPositionLoc = glGetAttribLocation(g_dwg.shaderProgram, "vPos");
-		g_dwg.vertexShaderColorLoc = glGetAttribLocation(g_dwg.shaderProgram, "vCol");
+		// the region was drawn DWG_STREAM_FRAMES frames ago, usually the fence is long signaled
+		GLsync& fence = stream.fences[stream.region];
+		if (fence)
+		{
+			while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED)
+			{
+			}
 
-		glEnable(GL_DEPTH_TEST);
+			glDeleteSync(fence);
+			fence = nullptr;
+		}
 
-		g_dwg.globalTime = glfwGetTime();
+		stream.mapped = stream.persistent + stream.region * stream.regionSize;
 	}
-
-	// create debug lines vertex buffer
+	else
 	{
-		g_dwg.dataLines = new DebugVertex[DWG_MAX_DEBUG_VERTICES];
-		memset(g_dwg.dataLines, 0, sizeof(DebugVertex) * DWG_MAX_DEBUG_VERTICES);
+		// orphaning, the driver gives us fresh memory while the GPU still reads the old one
+		glBindBuffer(GL_ARRAY_BUFFER, stream.buffer);
+		glBufferData(GL_ARRAY_BUFFER, stream.regionSize, NULL, GL_STREAM_DRAW);
 
-		glGenBuffers(1, &g_dwg.vertexBufferLines);
-		glBindBuffer(GL_ARRAY_BUFFER, g_dwg.vertexBufferLines);
-		glBufferData(GL_ARRAY_BUFFER, sizeof(DebugVertex) * DWG_MAX_DEBUG_VERTICES, g_dwg.dataLines, GL_DYNAMIC_DRAW);
+		if (GLAD_GL_VERSION_3_0)
+		{
+			stream.mapped = (uint8_t*)glMapBufferRange(GL_ARRAY_BUFFER, 0, stream.regionSize,
+				GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+		}
+		else
+		{
+			stream.mapped = (uint8_t*)glMapBuffer(GL_ARRAY_BUFFER, GL_WRITE_ONLY);
+		}
 	}
+}
 
-	// init debug spheres mesh vertex buffer + array
-	{
-		g_dwg.spheres = new DebugSphere[DWG_MAX_DEBUG_SPHERES];
-		g_dwg.numSpheres = 0;
-
-		const int32_t stackCount = 20;
-		const int32_t sectorCount = 30;
-		const float radius = 1.0f;
+// ends writing, returns offset of this frame's data in the buffer (bound to GL_ARRAY_BUFFER)
+static intptr_t dwgStreamEnd(DebugStreamBuffer& stream)
+{
+	glBindBuffer(GL_ARRAY_BUFFER, stream.buffer);
+	stream.mapped = nullptr;
 
-		g_dwg.numDataSphereVertices = (stackCount + 1) * (sectorCount + 1);
+	if (stream.persistent)
+		return (intptr_t)stream.region * stream.regionSize;
 
-		g_dwg.dataSphereMesh = new DebugVertex[g_dwg.numDataSphereVertices];
-		memset(g_dwg.dataSphereMesh, 0, sizeof(DebugVertex) * g_dwg.numDataSphereVertices);
+	glUnmapBuffer(GL_ARRAY_BUFFER);
+	return 0;
+}
 
-		float x, y, z, xy;								// vertex position
+// call after the last draw that reads this frame's data
+static void dwgStreamFence(DebugStreamBuffer& stream)
+{
+	if (stream.persistent)
+	{
+		stream.fences[stream.region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	}
+}
 
-		float sectorStep = 2 * (float)DWG_PI / sectorCount;
-		float stackStep = (float)DWG_PI / stackCount;
-		float sectorAngle, stackAngle;
+static void dwgStreamRelease(DebugStreamBuffer& stream)
+{
+	for (GLsync& fence : stream.fences)
+	{
+		if (fence)
+			glDeleteSync(fence);
+		fence = nullptr;
+	}
 
-		DebugVertex* vertex = g_dwg.dataSphereMesh;
+	glBindBuffer(GL_ARRAY_BUFFER, stream.buffer);
+	if (stream.persistent || stream.mapped)
+		glUnmapBuffer(GL_ARRAY_BUFFER);
 
-		const Vector3 fakeLightDir = { 1.0f, 1.0f, 1.0f };
+	glDeleteBuffers(1, &stream.buffer);
+	stream = DebugStreamBuffer();
+}
+#endif
 
-		for (int32_t i = 0; i <= stackCount; ++i)
-		{
-			stackAngle = (float)DWG_PI / 2 - i * stackStep;	// starting from pi/2 to -pi/2
-			xy = radius * cosf(stackAngle);				// r * cos(u)
-			z = radius * sinf(stackAngle);				// r * sin(u)
+DebugRecorder::~DebugRecorder()
+{
+	// chunks from the pool are owned by g_dwg
+	for (DebugLineChunk* chunk : lineChunks)
+	{
+		if (chunk->overflow)
+			spareLineChunks.push_back(chunk);
+	}
 
-			// add (sectorCount+1) vertices per stack
-			// the first and last vertices have same position
-			for (int32_t j = 0; j <= sectorCount; ++j)
-			{
-				sectorAngle = j * sectorStep;           // starting from 0 to 2pi
+	for (DebugLineChunk* chunk : spareLineChunks)
+	{
+		delete[] chunk->vertices;
+		delete chunk;
+	}
 
-				// vertex position (x, y, z)
-				x = xy * cosf(sectorAngle);             // r * cos(u) * cos(v)
-				y = xy * sinf(sectorAngle);             // r * cos(u) * sin(v)
-				
-				vertex->x = x;
-				vertex->y = y;
-				vertex->z = z;
+	for (DebugSphereChunk* chunk : sphereChunks)
+	{
+		delete chunk;
+	}
+}
 
-				Vector3 normal(x, y, z);
-				normal = normalize(normal);	// just in case
-				const float intensity = clamp(dot(normal, fakeLightDir), 0.0f, 1.0f);
+// recording context of the calling thread, created on first use
+static DebugRecorder& dwgRecorder()
+{
+	// the thread keeps a reference, when it exits dwgRender releases the recorder after drawing its data
+	thread_local std::shared_ptr<DebugRecorder> recorder;
 
-				vertex->r = 0.2f + intensity * 0.8f;
-				vertex->g = 0.2f + intensity * 0.8f;
-				vertex->b = 0.2f + intensity * 0.8f;
+	if (!recorder)
+	{
+		recorder = std::make_shared<DebugRecorder>();
 
-				vertex++;
-			}
+		DebugRecorderLink* link = new DebugRecorderLink();
+		link->recorder = recorder;
+		link->next = g_dwg.newRecorders.load(std::memory_order_relaxed);
+		while (!g_dwg.newRecorders.compare_exchange_weak(link->next, link, std::memory_order_release, std::memory_order_relaxed))
+		{
 		}
+	}
 
-		glGenBuffers(1, &g_dwg.vertexBufferSphereMesh);
-		glBindBuffer(GL_ARRAY_BUFFER, g_dwg.vertexBufferSphereMesh);
-		glBufferData(GL_ARRAY_BUFFER, sizeof(DebugVertex)* g_dwg.numDataSphereVertices, g_dwg.dataSphereMesh, GL_STATIC_DRAW);
+	return *recorder;
+}
 
-		// todo: rewrite that... I'm lazy
-		g_dwg.numSphereIndices = 0;
-		for (int i = 0; i < stackCount; ++i)
+// render thread only, maps the next chunk that is not in the ready list (or adds a new one)
+static DebugLineChunk* dwgMapFreeLineChunk()
+{
+	if (g_dwg.nextFreeLineChunk == (int32_t)g_dwg.lineChunks.size())
+	{
+		DebugLineChunk* chunk = new DebugLineChunk();
+		if (g_dwg.software)
 		{
-			for (int j = 0; j < sectorCount; ++j)
-			{
-				if (i != 0)
-				{
-					g_dwg.numSphereIndices += 3;
-				}
-
-				if (i != (stackCount - 1))
-				{
-					g_dwg.numSphereIndices += 3;
-				}
-			}
+			chunk->vertices = new DebugVertex[DWG_LINE_CHUNK_VERTICES];
 		}
-
-		g_dwg.sphereIndices = new uint16_t[g_dwg.numSphereIndices];
-		uint16_t* index = g_dwg.sphereIndices;
-
-		// generate CW index list of sphere triangles
-		// k1--k1+1
-		// |  / |
-		// | /  |
-		// k2--k2+1
-		uint16_t k1, k2;
-		for (uint16_t i = 0; i < stackCount; ++i)
+#if !DWG_NO_GL
+		else
 		{
-			k1 = i * (sectorCount + 1);	// beginning of current stack
-			k2 = k1 + sectorCount + 1;	// beginning of next stack
+			dwgStreamInit(chunk->stream, sizeof(DebugVertex) * DWG_LINE_CHUNK_VERTICES);
+		}
+#endif
+		g_dwg.lineChunks.push_back(chunk);
+	}
 
-			for (uint16_t j = 0; j < sectorCount; ++j, ++k1, ++k2)
-			{
-				// 2 triangles per sector excluding first and last stacks
-				// k1 => k2 => k1+1
-				if (i != 0)
-				{
-					index[0] = k1;
-					index[1] = k1 + 1;
-					index[2] = k2;
+	DebugLineChunk* chunk = g_dwg.lineChunks[g_dwg.nextFreeLineChunk++];
+#if !DWG_NO_GL
+	if (!g_dwg.software)
+	{
+		dwgStreamBegin(chunk->stream);
+		chunk->vertices = (DebugVertex*)chunk->stream.mapped;
+	}
+#endif
+	chunk->numVertices = 0;
 
-					index += 3;
-				}
+	return chunk;
+}
 
-				// k1+1 => k2 => k2+1
-				if (i != (stackCount - 1))
-				{
-					index[0] = k1 + 1;
-					index[1] = k2 + 1;
-					index[2] = k2;
+// maps enough chunks for the next frame, as many as this frame used + 1
+static void dwgPrepareLineChunks()
+{
+	const int32_t numReady = (int32_t)g_dwg.readyLineChunks.size();
+	const int32_t numUsed = DWG_MIN(g_dwg.nextReadyLineChunk.load(), numReady);
+	const int32_t numNeeded = numUsed + (g_dwg.nextFreeLineChunk - numReady) + 1;
 
-					index += 3;
-				}
-			}
-		}
+	g_dwg.nextFreeLineChunk = 0;
+	g_dwg.readyLineChunks.clear();
 
-		glGenBuffers(1, &g_dwg.indexBufferSphereMesh);
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, g_dwg.indexBufferSphereMesh);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(uint16_t) * g_dwg.numSphereIndices, g_dwg.sphereIndices, GL_STATIC_DRAW);
+	for (int32_t i = 0; i < numNeeded; ++i)
+	{
+		g_dwg.readyLineChunks.push_back(dwgMapFreeLineChunk());
 	}
 
-	return true;
+	g_dwg.nextReadyLineChunk = 0;
 }
 
-bool dwgShouldClose()
+// fake light baked to the vertex colors of the sphere meshes
+static DebugVertex dwgSphereVertex(const Vector3& position)
 {
-	return glfwWindowShouldClose(g_dwg.window);
+	const Vector3 fakeLightDir = { 1.0f, 1.0f, 1.0f };
+	const Vector3 normal = normalize(position);	// just in case
+	const float intensity = clamp(dot(normal, fakeLightDir), 0.0f, 1.0f);
+
+	DebugVertex vertex;
+	vertex.x = position.getX();
+	vertex.y = position.getY();
+	vertex.z = position.getZ();
+	vertex.r = 0.2f + intensity * 0.8f;
+	vertex.g = 0.2f + intensity * 0.8f;
+	vertex.b = 0.2f + intensity * 0.8f;
+	return vertex;
 }
 
-void dwgRender(const Matrix4& camera, const float fov)
+// stack/sector sphere, even spacing of the stacks looks best up close
+static DebugSphereLod dwgAddUvSphere(std::vector<DebugVertex>& vertices, std::vector<uint16_t>& indices, int32_t stackCount, int32_t sectorCount)
 {
-	// update debug vertex buffers
+	DebugSphereLod lod;
+	lod.firstVertex = (int32_t)vertices.size();
+	lod.firstIndex = (int32_t)indices.size();
+
+	const float sectorStep = 2 * (float)DWG_PI / sectorCount;
+	const float stackStep = (float)DWG_PI / stackCount;
+
+	for (int32_t i = 0; i <= stackCount; ++i)
 	{
-		// lines
-		if (g_dwg.numDataLines > 0)
+		const float stackAngle = (float)DWG_PI / 2 - i * stackStep;	// starting from pi/2 to -pi/2
+		const float xy = cosf(stackAngle);	// r * cos(u)
+		const float z = sinf(stackAngle);	// r * sin(u)
+
+		// add (sectorCount+1) vertices per stack
+		// the first and last vertices have same position
+		for (int32_t j = 0; j <= sectorCount; ++j)
 		{
-			glBindBuffer(GL_ARRAY_BUFFER, g_dwg.vertexBufferLines);
-			void* ptr = glMapBuffer(GL_ARRAY_BUFFER, GL_WRITE_ONLY);
-			GLenum err = glGetError();
-			memcpy(ptr, g_dwg.dataLines, sizeof(DebugVertex) * g_dwg.numDataLines);
-			glUnmapBuffer(GL_ARRAY_BUFFER);
+			const float sectorAngle = j * sectorStep;	// starting from 0 to 2pi
+			vertices.push_back(dwgSphereVertex(Vector3(xy * cosf(sectorAngle), xy * sinf(sectorAngle), z)));
 		}
 	}
 
-	// render current frame
+	// generate CW index list of sphere triangles
+	// k1--k1+1
+	// |  / |
+	// | /  |
+	// k2--k2+1
+	for (int32_t i = 0; i < stackCount; ++i)
 	{
-		float ratio;
-		int width, height;
-
-		glfwGetFramebufferSize(g_dwg.window, &width, &height);
-		ratio = width / (float)height;
-
-		const float viewHalfLength = 10.0f;
-		Matrix4 p = Matrix4::perspective(fov * (float)DWG_PI / 360.0f, ratio, 0.1f, 1000.0f);
-		Matrix4 mvp = p * camera;
-
-		glViewport(0, 0, width, height);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		uint16_t k1 = (uint16_t)(lod.firstVertex + i * (sectorCount + 1));	// beginning of current stack
+		uint16_t k2 = (uint16_t)(k1 + sectorCount + 1);	// beginning of next stack
 
-		glUseProgram(g_dwg.shaderProgram);
-
-		// draw lines
-		if(g_dwg.numDataLines > 0)
+		for (int32_t j = 0; j < sectorCount; ++j, ++k1, ++k2)
 		{
-			const Vector3 colorWhite = { 1.0f, 1.0f, 1.0f };
-			glUniform3fv(g_dwg.vertexShaderTintLoc, 1, toFloatPtr(colorWhite));
-			glBindBuffer(GL_ARRAY_BUFFER, g_dwg.vertexBufferLines);
-			glUniformMatrix4fv(g_dwg.vertexShaderMVPLoc, 1, GL_FALSE, (const GLfloat*)&mvp);
-
-			// todo: do I need to call it here? I don't remember...
-			glEnableVertexAttribArray(g_dwg.vertexShaderPositionLoc);
-			glVertexAttribPointer(g_dwg.vertexShaderPositionLoc, 3, GL_FLOAT, GL_FALSE,
-				sizeof(DebugVertex), (void*)0);
-			glEnableVertexAttribArray(g_dwg.vertexShaderColorLoc);
-			glVertexAttribPointer(g_dwg.vertexShaderColorLoc, 3, GL_FLOAT, GL_FALSE,
-				sizeof(DebugVertex), (void*)(sizeof(float) * 3));
+			// 2 triangles per sector excluding first and last stacks
+			// k1 => k1+1 => k2
+			if (i != 0)
+			{
+				const uint16_t triangle[] = { k1, (uint16_t)(k1 + 1), k2 };
+				indices.insert(indices.end(), triangle, triangle + 3);
+			}
 
-			glDrawArrays(GL_LINES, 0, g_dwg.numDataLines);
+			// k1+1 => k2+1 => k2
+			if (i != (stackCount - 1))
+			{
+				const uint16_t triangle[] = { (uint16_t)(k1 + 1), (uint16_t)(k2 + 1), k2 };
+				indices.insert(indices.end(), triangle, triangle + 3);
+			}
 		}
+	}
 
-		if (g_dwg.numSpheres > 0)
-		{
-			Matrix4 mvpSphere = Matrix4::identity();
+	lod.numVertices = (int32_t)vertices.size() - lod.firstVertex;
+	lod.numIndices = (int32_t)indices.size() - lod.firstIndex;
+	return lod;
+}
 
-			glBindBuffer(GL_ARRAY_BUFFER, g_dwg.vertexBufferSphereMesh);
-			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, g_dwg.indexBufferSphereMesh);
+// subdivided icosahedron, evenly spread triangles give the roundest outline for a low triangle count
+// 0 subdivisions = 20 triangles, every subdivision gives 4 times more
+static DebugSphereLod dwgAddIcosphere(std::vector<DebugVertex>& vertices, std::vector<uint16_t>& indices, int32_t subdivisions)
+{
+	const float t = (1.0f + sqrtf(5.0f)) * 0.5f;
+	std::vector<Vector3> positions = {
+		{ -1.0f, t, 0.0f }, { 1.0f, t, 0.0f }, { -1.0f, -t, 0.0f }, { 1.0f, -t, 0.0f },
+		{ 0.0f, -1.0f, t }, { 0.0f, 1.0f, t }, { 0.0f, -1.0f, -t }, { 0.0f, 1.0f, -t },
+		{ t, 0.0f, -1.0f }, { t, 0.0f, 1.0f }, { -t, 0.0f, -1.0f }, { -t, 0.0f, 1.0f } };
+	std::vector<int32_t> triangles = {
+		0, 11, 5, 0, 5, 1, 0, 1, 7, 0, 7, 10, 0, 10, 11, 1, 5, 9, 5, 11, 4, 11, 10, 2, 10, 7, 6, 7, 1, 8,
+		3, 9, 4, 3, 4, 2, 3, 2, 6, 3, 6, 8, 3, 8, 9, 4, 9, 5, 2, 4, 11, 6, 2, 10, 8, 6, 7, 9, 8, 1 };
+
+	for (Vector3& position : positions)
+	{
+		position = normalize(position);
+	}
 
-			// todo: do I need to call it here? I don't remember...
-			glEnableVertexAttribArray(g_dwg.vertexShaderPositionLoc);
-			glVertexAttribPointer(g_dwg.vertexShaderPositionLoc, 3, GL_FLOAT, GL_FALSE,
-				sizeof(DebugVertex), (void*)0);
-			glEnableVertexAttribArray(g_dwg.vertexShaderColorLoc);
-			glVertexAttribPointer(g_dwg.vertexShaderColorLoc, 3, GL_FLOAT, GL_FALSE,
-				sizeof(DebugVertex), (void*)(sizeof(float) * 3));
+	// every triangle is split to 4, vertices in the middle of the edges are shared by both triangles of the edge
+	for (int32_t level = 0; level < subdivisions; ++level)
+	{
+		std::vector<int32_t> split;
+		std::vector<std::pair<uint32_t, int32_t>> midpoints;	// (edge, vertex), sorted by edge
 
-			// todo: rewrite to mesh instancing
-			for (int32_t i = 0; i < g_dwg.numSpheres; ++i)
-			{
-				const DebugSphere& sphere = g_dwg.spheres[i];
-				mvpSphere = mvp * sphere.worldLocation;
+		auto midpoint = [&](int32_t a, int32_t b)
+		{
+			const uint32_t edge = a < b ? ((uint32_t)a << 16) | (uint32_t)b : ((uint32_t)b << 16) | (uint32_t)a;
+			auto it = std::lower_bound(midpoints.begin(), midpoints.end(), std::make_pair(edge, INT32_MIN));
+			if (it != midpoints.end() && it->first == edge)
+				return it->second;
 
-				glUniform3fv(g_dwg.vertexShaderTintLoc, 1, toFloatPtr(sphere.color));
-				glUniformMatrix4fv(g_dwg.vertexShaderMVPLoc, 1, GL_FALSE, (const GLfloat*)&mvpSphere);
+			positions.push_back(normalize(positions[a] + positions[b]));
+			midpoints.insert(it, std::make_pair(edge, (int32_t)positions.size() - 1));
+			return (int32_t)positions.size() - 1;
+		};
 
-				glDrawElements(GL_TRIANGLES, g_dwg.numSphereIndices, GL_UNSIGNED_SHORT, NULL);
-			}
+		for (size_t i = 0; i < triangles.size(); i += 3)
+		{
+			const int32_t a = triangles[i];
+			const int32_t b = triangles[i + 1];
+			const int32_t c = triangles[i + 2];
+			const int32_t ab = midpoint(a, b);
+			const int32_t bc = midpoint(b, c);
+			const int32_t ca = midpoint(c, a);
+
+			const int32_t children[] = { a, ab, ca, b, bc, ab, c, ca, bc, ab, bc, ca };
+			split.insert(split.end(), children, children + 12);
 		}
 
-		glfwSwapBuffers(g_dwg.window);
-		glfwPollEvents();
+		triangles.swap(split);
 	}
 
-	// clear stuff for the next update + calculate delta time
+	DebugSphereLod lod;
+	lod.firstVertex = (int32_t)vertices.size();
+	lod.firstIndex = (int32_t)indices.size();
+
+	for (const Vector3& position : positions)
 	{
-		g_dwg.numDataLines = 0;
-		g_dwg.numSpheres = 0;
+		vertices.push_back(dwgSphereVertex(position));
+	}
 
-		const double nextTime = glfwGetTime();
-		g_dwg.deltaTime = DWG_MIN((float)(nextTime - g_dwg.globalTime), 0.1f);	// clamp max time to 0.1, so we have something predictable once placing breakpoint in code
-		g_dwg.globalTime = nextTime;
+	// the same winding as the stack/sector sphere (cross of the edges points inside)
+	for (size_t i = 0; i < triangles.size(); i += 3)
+	{
+		int32_t a = triangles[i];
+		int32_t b = triangles[i + 1];
+		const int32_t c = triangles[i + 2];
+
+		if (dot(cross(positions[b] - positions[a], positions[c] - positions[a]), positions[a]) > 0.0f)
+			std::swap(a, b);
+
+		const uint16_t triangle[] = { (uint16_t)(lod.firstVertex + a), (uint16_t)(lod.firstVertex + b), (uint16_t)(lod.firstVertex + c) };
+		indices.insert(indices.end(), triangle, triangle + 3);
 	}
+
+	lod.numVertices = (int32_t)vertices.size() - lod.firstVertex;
+	lod.numIndices = (int32_t)indices.size() - lod.firstIndex;
+	return lod;
 }
 
-void dwgReleaseApp()
+// corners of the impostor quad in x and y, the vertex shader puts it in front of the sphere
+static DebugSphereLod dwgAddImpostorQuad(std::vector<DebugVertex>& vertices, std::vector<uint16_t>& indices)
 {
-	delete[] g_dwg.dataLines;
-	delete[] g_dwg.sphereIndices;
-	delete[] g_dwg.dataSphereMesh;
-	delete[] g_dwg.spheres;
+	DebugSphereLod lod;
+	lod.firstVertex = (int32_t)vertices.size();
+	lod.firstIndex = (int32_t)indices.size();
+	lod.numVertices = 4;
+	lod.numIndices = 6;
+
+	const float corners[4][2] = { { -1.0f, -1.0f }, { 1.0f, -1.0f }, { 1.0f, 1.0f }, { -1.0f, 1.0f } };
+	for (const float* corner : corners)
+	{
+		vertices.push_back({ corner[0], corner[1], 0.0f, 1.0f, 1.0f, 1.0f });
+	}
 
-	glfwDestroyWindow(g_dwg.window);
-	glfwTerminate();
-}
+	const uint16_t first = (uint16_t)lod.firstVertex;
+	const uint16_t quad[] = { first, (uint16_t)(first + 1), (uint16_t)(first + 2), first, (uint16_t)(first + 2), (uint16_t)(first + 3) };
+	indices.insert(indices.end(), quad, quad + 6);
 
-float dwgDeltaTime()
-{
-	return g_dwg.deltaTime;
+	return lod;
 }
 
-double dwgGlobalTime()
+// current time in seconds
+static double dwgTime()
 {
-	return g_dwg.globalTime;
+#if !DWG_NO_GL
+	if (!g_dwg.software)
+		return glfwGetTime();
+#endif
+
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - g_dwg.startTime).count();
 }
 
-void dwgDebugLine(const Vector3& start, const Vector3& end, const Vector3& color)
+#if !DWG_NO_GL
+// window, context and pipeline of the OpenGL renderer
+static bool dwgInitGL(int32_t width, int32_t height, const char* title, uint32_t flags)
 {
-	assert(g_dwg.numDataLines + 2 < DWG_MAX_DEBUG_VERTICES && g_dwg.dataLines != nullptr);
+	// init window
+	{
+		glfwSetErrorCallback(error_callback);
 
-	DebugVertex* v = &g_dwg.dataLines[g_dwg.numDataLines];
+		if (!glfwInit())
+			return false;
 
-	v->x = start.getX();
-	v->y = start.getY();
-	v->z = start.getZ();
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 2);
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 0);
 
-	v->r = color.getX();
-	v->g = color.getY();
-	v->b = color.getZ();
+		const bool headless = (flags & DWG_APP_HEADLESS) != 0;
+		if (headless)
+		{
+			// the window only holds the context, we render to a framebuffer object
+			glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+		}
 
-	++v;
+		g_dwg.window = glfwCreateWindow(width, height, title, NULL, NULL);
 
-	v->x = end.getX();
-	v->y = end.getY();
-	v->z = end.getZ();
+		// no display, try software Mesa (when glfw is built with OSMesa)
+		if (!g_dwg.window && headless)
+		{
+			glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+			g_dwg.window = glfwCreateWindow(width, height, title, NULL, NULL);
+		}
 
-	v->r = color.getX();
-	v->g = color.getY();
-	v->b = color.getZ();
+		if (!g_dwg.window)
+		{
+			glfwTerminate();
+			return false;
+		}
 
-	g_dwg.numDataLines += 2;
+		glfwSetKeyCallback(g_dwg.window, key_callback);
+	}
+	
+	// init OpenGL
+	{
+		glfwMakeContextCurrent(g_dwg.window);
+		gladLoadGL();
+		glfwSwapInterval((flags & DWG_APP_HEADLESS) ? 0 : 1);	// headless runs as fast as it can
+	}
+
+	// offscreen framebuffer, without framebuffer objects (GL 2.x) we draw to the hidden window
+	if ((flags & DWG_APP_HEADLESS) && GLAD_GL_VERSION_3_0)
+	{
+		glGenRenderbuffers(1, &g_dwg.colorRenderbuffer);
+		glBindRenderbuffer(GL_RENDERBUFFER, g_dwg.colorRenderbuffer);
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+		glGenRenderbuffers(1, &g_dwg.depthRenderbuffer);
+		glBindRenderbuffer(GL_RENDERBUFFER, g_dwg.depthRenderbuffer);
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+
+		glGenFramebuffers(1, &g_dwg.framebuffer);
+		glBindFramebuffer(GL_FRAMEBUFFER, g_dwg.framebuffer);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, g_dwg.colorRenderbuffer);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, g_dwg.depthRenderbuffer);
+
+		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		{
+			fprintf(stderr, "Error: offscreen framebuffer is not complete\n");
+			dwgReleaseApp();
+			return false;
+		}
+	}
+	
+	// init rendering
+	{
+		g_dwg.vertexShader = glCreateShader(GL_VERTEX_SHADER);
+		glShaderSource(g_dwg.vertexShader, 1, &vertex_shader_text, NULL);
+		glCompileShader(g_dwg.vertexShader);
+
+		g_dwg.fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+		glShaderSource(g_dwg.fragmentShader, 1, &fragment_shader_text, NULL);
+		glCompileShader(g_dwg.fragmentShader);
+
+		g_dwg.shaderProgram = glCreateProgram();
+		glAttachShader(g_dwg.shaderProgram, g_dwg.vertexShader);
+		glAttachShader(g_dwg.shaderProgram, g_dwg.fragmentShader);
+		glLinkProgram(g_dwg.shaderProgram);
+
+		g_dwg.vertexShaderMVPLoc = glGetUniformLocation(g_dwg.shaderProgram, "MVP");
+		g_dwg.vertexShaderTintLoc = glGetUniformLocation(g_dwg.shaderProgram, "tint");
+		g_dwg.vertexShaderPositionLoc = glGetAttribLocation(g_dwg.shaderProgram, "vPos");
+		g_dwg.vertexShaderColorLoc = glGetAttribLocation(g_dwg.shaderProgram, "vCol");
+
+		// spheres share the fragment shader
+		g_dwg.sphereVertexShader = glCreateShader(GL_VERTEX_SHADER);
+		glShaderSource(g_dwg.sphereVertexShader, 1, &sphere_vertex_shader_text, NULL);
+		glCompileShader(g_dwg.sphereVertexShader);
+
+		g_dwg.sphereShaderProgram = glCreateProgram();
+		glAttachShader(g_dwg.sphereShaderProgram, g_dwg.sphereVertexShader);
+		glAttachShader(g_dwg.sphereShaderProgram, g_dwg.fragmentShader);
+		glBindAttribLocation(g_dwg.sphereShaderProgram, 0, "vPos");	// attribute 0 can't be a constant one in compatibility contexts
+		glLinkProgram(g_dwg.sphereShaderProgram);
+
+		g_dwg.sphereShaderMVPLoc = glGetUniformLocation(g_dwg.sphereShaderProgram, "MVP");
+		g_dwg.sphereShaderPositionLoc = glGetAttribLocation(g_dwg.sphereShaderProgram, "vPos");
+		g_dwg.sphereShaderColorLoc = glGetAttribLocation(g_dwg.sphereShaderProgram, "vCol");
+		g_dwg.sphereShaderInstancePositionLoc = glGetAttribLocation(g_dwg.sphereShaderProgram, "iPosition");
+		g_dwg.sphereShaderInstanceScaleLoc = glGetAttribLocation(g_dwg.sphereShaderProgram, "iScale");
+		g_dwg.sphereShaderInstanceRotationLoc = glGetAttribLocation(g_dwg.sphereShaderProgram, "iRotation");
+		g_dwg.sphereShaderInstanceColorLoc = glGetAttribLocation(g_dwg.sphereShaderProgram, "iColor");
+
+		g_dwg.impostorVertexShader = glCreateShader(GL_VERTEX_SHADER);
+		glShaderSource(g_dwg.impostorVertexShader, 1, &impostor_vertex_shader_text, NULL);
+		glCompileShader(g_dwg.impostorVertexShader);
+
+		g_dwg.impostorFragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+		glShaderSource(g_dwg.impostorFragmentShader, 1, &impostor_fragment_shader_text, NULL);
+		glCompileShader(g_dwg.impostorFragmentShader);
+
+		g_dwg.impostorShaderProgram = glCreateProgram();
+		glAttachShader(g_dwg.impostorShaderProgram, g_dwg.impostorVertexShader);
+		glAttachShader(g_dwg.impostorShaderProgram, g_dwg.impostorFragmentShader);
+		glBindAttribLocation(g_dwg.impostorShaderProgram, 0, "vPos");
+		glLinkProgram(g_dwg.impostorShaderProgram);
+
+		g_dwg.impostorShaderMVPLoc = glGetUniformLocation(g_dwg.impostorShaderProgram, "MVP");
+		g_dwg.impostorShaderEyeLoc = glGetUniformLocation(g_dwg.impostorShaderProgram, "eye");
+		g_dwg.impostorShaderPositionLoc = glGetAttribLocation(g_dwg.impostorShaderProgram, "vPos");
+		g_dwg.impostorShaderInstancePositionLoc = glGetAttribLocation(g_dwg.impostorShaderProgram, "iPosition");
+		g_dwg.impostorShaderInstanceScaleLoc = glGetAttribLocation(g_dwg.impostorShaderProgram, "iScale");
+		g_dwg.impostorShaderInstanceRotationLoc = glGetAttribLocation(g_dwg.impostorShaderProgram, "iRotation");
+		g_dwg.impostorShaderInstanceColorLoc = glGetAttribLocation(g_dwg.impostorShaderProgram, "iColor");
+
+		// we ask for 2.0, but drivers usually give the newest compatibility context
+		g_dwg.instancing = GLAD_GL_VERSION_3_3 != 0;
+
+		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);	// opaque black, like the software renderer
+		glEnable(GL_DEPTH_TEST);
+	}
+
+	return true;
+}
+#endif
+
+bool dwgInitApp(int32_t width, int32_t height, const char* title, uint32_t flags)
+{
+	g_dwg.flags = flags;
+	g_dwg.width = width;
+	g_dwg.height = height;
+	g_dwg.software = DWG_NO_GL || (flags & DWG_APP_SOFTWARE) != 0;
+
+#if !DWG_NO_GL
+	if (!g_dwg.software && !dwgInitGL(width, height, title, flags))
+		return false;
+#else
+	(void)title;
+#endif
+
+	g_dwg.startTime = std::chrono::steady_clock::now();
+	g_dwg.globalTime = dwgTime();
+
+	// create debug lines vertex buffers
+	{
+		g_dwg.renderThread = std::this_thread::get_id();
+		dwgPrepareLineChunks();
+	}
+
+	// init debug sphere meshes, all LODs are in one vertex and one index buffer
+	{
+		g_dwg.sphereLods[0] = dwgAddUvSphere(g_dwg.sphereVertices, g_dwg.sphereIndices, 20, 30);
+		g_dwg.sphereLods[1] = dwgAddIcosphere(g_dwg.sphereVertices, g_dwg.sphereIndices, 2);
+		g_dwg.sphereLods[2] = dwgAddIcosphere(g_dwg.sphereVertices, g_dwg.sphereIndices, 1);
+		g_dwg.sphereLods[3] = dwgAddIcosphere(g_dwg.sphereVertices, g_dwg.sphereIndices, 0);
+		g_dwg.sphereLods[DWG_SPHERE_IMPOSTOR] = dwgAddImpostorQuad(g_dwg.sphereVertices, g_dwg.sphereIndices);
+
+		if (g_dwg.software)
+		{
+			dwgSoftwareSetSphereMesh(g_dwg.softwareRenderer, g_dwg.sphereVertices.data(), (int32_t)g_dwg.sphereVertices.size(),
+				g_dwg.sphereIndices.data(), (int32_t)g_dwg.sphereIndices.size(), g_dwg.sphereLods, DWG_SPHERE_LODS + 1);
+		}
+#if !DWG_NO_GL
+		else
+		{
+			glGenBuffers(1, &g_dwg.vertexBufferSphereMesh);
+			glBindBuffer(GL_ARRAY_BUFFER, g_dwg.vertexBufferSphereMesh);
+			glBufferData(GL_ARRAY_BUFFER, sizeof(DebugVertex) * g_dwg.sphereVertices.size(), g_dwg.sphereVertices.data(), GL_STATIC_DRAW);
+
+			glGenBuffers(1, &g_dwg.indexBufferSphereMesh);
+			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, g_dwg.indexBufferSphereMesh);
+			glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(uint16_t) * g_dwg.sphereIndices.size(), g_dwg.sphereIndices.data(), GL_STATIC_DRAW);
+
+			// per instance data, DebugSphere array is uploaded as it is
+			if (g_dwg.instancing)
+			{
+				glGenBuffers(1, &g_dwg.instanceBufferSpheres);
+				glBindBuffer(GL_ARRAY_BUFFER, g_dwg.instanceBufferSpheres);
+				glBufferData(GL_ARRAY_BUFFER, sizeof(DebugSphere) * DWG_SPHERE_CHUNK_SPHERES, NULL, GL_STREAM_DRAW);
+			}
+		}
+#endif
+	}
+
+	return true;
+}
+
+bool dwgShouldClose()
+{
+#if !DWG_NO_GL
+	if (!g_dwg.software)
+		return glfwWindowShouldClose(g_dwg.window);
+#endif
+
+	// no window to close
+	return false;
+}
+
+#if !DWG_NO_GL
+// maps the pixel buffer of an older frame and gives it to the writer thread
+static void dwgCaptureSlot(int32_t slot)
+{
+	if (g_dwg.captureWidths[slot] == 0)
+		return;
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, g_dwg.captureBuffers[slot]);
+
+	if (g_dwg.captureFences[slot])
+	{
+		while (glClientWaitSync(g_dwg.captureFences[slot], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED)
+		{
+		}
+
+		glDeleteSync(g_dwg.captureFences[slot]);
+		g_dwg.captureFences[slot] = nullptr;
+	}
+
+	const uint8_t* pixels = (const uint8_t*)glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+	if (pixels)
+	{
+		dwgCaptureFrame(pixels, g_dwg.captureWidths[slot], g_dwg.captureHeights[slot], true);
+		glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+	}
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	g_dwg.captureWidths[slot] = 0;
+}
+
+// reads the frame that was just rendered
+static void dwgCaptureRenderedFrame(int32_t width, int32_t height)
+{
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+
+	// fences come with GL 3.2, older contexts read synchronously
+	if (!GLAD_GL_VERSION_3_2)
+	{
+		g_dwg.capturePixels.resize((size_t)width * height * 4);
+		glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, g_dwg.capturePixels.data());
+		dwgCaptureFrame(g_dwg.capturePixels.data(), width, height, true);
+		return;
+	}
+
+	// the buffer still holds the frame from DWG_STREAM_FRAMES frames ago
+	const int32_t slot = g_dwg.captureSlot;
+	dwgCaptureSlot(slot);
+
+	if (g_dwg.captureBuffers[slot] == 0)
+	{
+		glGenBuffers(1, &g_dwg.captureBuffers[slot]);
+	}
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, g_dwg.captureBuffers[slot]);
+	glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)width * height * 4, NULL, GL_STREAM_READ);
+	glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, (void*)0);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	g_dwg.captureFences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	g_dwg.captureWidths[slot] = width;
+	g_dwg.captureHeights[slot] = height;
+	g_dwg.captureSlot = (slot + 1) % DWG_STREAM_FRAMES;
+}
+
+// gives the frames that are still in pixel buffers to the writer thread, oldest first
+static void dwgFlushCapture()
+{
+	for (int32_t i = 0; i < DWG_STREAM_FRAMES; ++i)
+	{
+		dwgCaptureSlot((g_dwg.captureSlot + i) % DWG_STREAM_FRAMES);
+	}
+}
+#endif
+
+bool dwgStartCapture(const char* pathFormat, CaptureFormat format)
+{
+	dwgStopCapture();
+	return dwgCaptureBegin(pathFormat, format);
+}
+
+void dwgStopCapture()
+{
+#if !DWG_NO_GL
+	if (!g_dwg.software)
+		dwgFlushCapture();
+#endif
+	dwgCaptureEnd();
+}
+
+// moves the recorders of threads that started recording to g_dwg.recorders (in the order they started)
+static void dwgTakeNewRecorders()
+{
+	DebugRecorderLink* link = g_dwg.newRecorders.exchange(nullptr, std::memory_order_acquire);
+
+	const size_t first = g_dwg.recorders.size();
+	while (link)
+	{
+		DebugRecorderLink* next = link->next;
+		g_dwg.recorders.push_back(std::move(link->recorder));
+		delete link;
+		link = next;
+	}
+	std::reverse(g_dwg.recorders.begin() + first, g_dwg.recorders.end());
+}
+
+// collects the segments of all threads, overflow chunks are copied to mapped chunks
+static void dwgMergeRecorders()
+{
+	g_dwg.drawLineChunks.clear();
+	g_dwg.drawLineSegments.clear();
+	g_dwg.drawSphereSegments.clear();
+
+	// threads don't record during dwgRender, new ones only push to the lock free list, so no lock is needed
+	dwgTakeNewRecorders();
+
+	g_dwg.stats.numSphereChunks = 0;
+	for (const std::shared_ptr<DebugRecorder>& recorder : g_dwg.recorders)
+	{
+		g_dwg.stats.numSphereChunks += (int32_t)recorder->sphereChunks.size();
+
+		for (DebugLineChunk* chunk : recorder->lineChunks)
+		{
+			// the software renderer reads the CPU memory directly
+			if (chunk->overflow && !g_dwg.software)
+			{
+				DebugLineChunk* target = dwgMapFreeLineChunk();
+				memcpy(target->vertices, chunk->vertices, sizeof(DebugVertex) * chunk->numVertices);
+				target->numVertices = chunk->numVertices;
+				memcpy(target->blockMin, chunk->blockMin, sizeof(chunk->blockMin));
+				memcpy(target->blockMax, chunk->blockMax, sizeof(chunk->blockMax));
+
+				chunk->uploaded = target;
+				chunk = target;
+			}
+
+			g_dwg.drawLineChunks.push_back(chunk);
+		}
+
+		for (DebugLineSegment segment : recorder->lineSegments)
+		{
+			if (segment.count == 0)
+				continue;
+
+			if (segment.chunk->overflow && !g_dwg.software)
+				segment.chunk = segment.chunk->uploaded;
+
+			g_dwg.drawLineSegments.push_back(segment);
+		}
+
+		for (const DebugSphereSegment& segment : recorder->sphereSegments)
+		{
+			if (segment.count > 0)
+				g_dwg.drawSphereSegments.push_back(segment);
+		}
+	}
+
+	// the same keys give the same order, no matter which thread recorded what
+	if (g_dwg.stableOrder)
+	{
+		std::stable_sort(g_dwg.drawLineSegments.begin(), g_dwg.drawLineSegments.end(),
+			[](const DebugLineSegment& a, const DebugLineSegment& b) { return a.key < b.key; });
+		std::stable_sort(g_dwg.drawSphereSegments.begin(), g_dwg.drawSphereSegments.end(),
+			[](const DebugSphereSegment& a, const DebugSphereSegment& b) { return a.key < b.key; });
+	}
+}
+
+// planes of the view frustum in the world space (left, right, bottom, top, near, far) from the rows of mvp
+// the normals point inside and have unit length, so the distance of a point is dot(plane.xyz, point) + plane.w
+static void dwgFrustumPlanes(const Matrix4& mvp, Vector4* planes)
+{
+	const Vector4 rowX = mvp.getRow(0);
+	const Vector4 rowY = mvp.getRow(1);
+	const Vector4 rowZ = mvp.getRow(2);
+	const Vector4 rowW = mvp.getRow(3);
+
+	planes[0] = rowW + rowX;
+	planes[1] = rowW - rowX;
+	planes[2] = rowW + rowY;
+	planes[3] = rowW - rowY;
+	planes[4] = rowW + rowZ;
+	planes[5] = rowW - rowZ;
+
+	for (int32_t i = 0; i < 6; ++i)
+	{
+		planes[i] /= length(planes[i].getXYZ());
+	}
+}
+
+// the box is outside when its corner furthest along the normal is behind any plane
+static bool dwgBoxVisible(const Vector4* planes, const float* boxMin, const float* boxMax)
+{
+	for (int32_t i = 0; i < 6; ++i)
+	{
+		const float nx = planes[i].getX();
+		const float ny = planes[i].getY();
+		const float nz = planes[i].getZ();
+
+		const float x = nx >= 0.0f ? boxMax[0] : boxMin[0];
+		const float y = ny >= 0.0f ? boxMax[1] : boxMin[1];
+		const float z = nz >= 0.0f ? boxMax[2] : boxMin[2];
+
+		if (nx * x + ny * y + nz * z + planes[i].getW() < 0.0f)
+			return false;
+	}
+
+	return true;
+}
+
+// splits the line segments to the visible ranges, blocks outside of the frustum are skipped
+// ranges that follow each other in a chunk are merged, so every range is one draw call
+static void dwgCullLines(const Vector4* planes)
+{
+	std::vector<DebugLineRange>& ranges = g_dwg.drawLineRanges;
+	ranges.clear();
+
+	int32_t numCulled = 0;
+	for (const DebugLineSegment& segment : g_dwg.drawLineSegments)
+	{
+		const int32_t end = segment.first + segment.count;
+		for (int32_t first = segment.first; first < end; )
+		{
+			const int32_t block = first / DWG_LINE_CULL_BLOCK_VERTICES;
+			const int32_t count = std::min(end, (block + 1) * DWG_LINE_CULL_BLOCK_VERTICES) - first;
+
+			if (g_dwg.culling && !dwgBoxVisible(planes, segment.chunk->blockMin[block], segment.chunk->blockMax[block]))
+			{
+				numCulled += count / 2;
+			}
+			else if (!ranges.empty() && ranges.back().chunk == segment.chunk && ranges.back().first + ranges.back().count == first)
+			{
+				ranges.back().count += count;
+			}
+			else
+			{
+				ranges.push_back({ segment.chunk, first, count });
+			}
+
+			first += count;
+		}
+	}
+
+	g_dwg.stats.numCulledLines = numCulled;
+	g_dwg.stats.numLines -= numCulled;
+}
+
+// w is the distance along the view direction, lodScale is the radius in pixels of a unit sphere at the distance 1
+// with impostors on, all spheres in front of the near plane are impostors
+static inline void dwgAddLodSphere(const DebugSphere& sphere, float w, float radius, float lodScale)
+{
+	// the finest mesh when the camera is close or inside
+	int32_t lod = 0;
+	if (g_dwg.impostors && w - radius > DWG_NEAR_PLANE)
+	{
+		lod = DWG_SPHERE_IMPOSTOR;
+	}
+	else if (w > radius)
+	{
+		const float pixels = radius * lodScale / w;
+		while (lod + 1 < DWG_SPHERE_LODS && pixels < s_sphereLodRadii[lod])
+		{
+			++lod;
+		}
+	}
+
+	g_dwg.lodSpheres[lod].push_back(sphere);
+}
+
+// culls the spheres by their bounding spheres and sorts the rest to the LODs by their projected radius
+static void dwgSelectSpheres(const Matrix4& mvp, const Vector4* planes, float lodScale)
+{
+	for (std::vector<DebugSphere>& spheres : g_dwg.lodSpheres)
+	{
+		spheres.clear();
+	}
+
+	// w of the clip space is the distance along the view direction
+	const Vector4 row = mvp.getRow(3);
+	const float rowX = row.getX();
+	const float rowY = row.getY();
+	const float rowZ = row.getZ();
+	const float rowW = row.getW();
+
+#if VECTORMATH_MODE_SSE
+	__m128 planeX[6], planeY[6], planeZ[6], planeW[6];
+	for (int32_t i = 0; i < 6; ++i)
+	{
+		planeX[i] = _mm_set1_ps(planes[i].getX());
+		planeY[i] = _mm_set1_ps(planes[i].getY());
+		planeZ[i] = _mm_set1_ps(planes[i].getZ());
+		planeW[i] = _mm_set1_ps(planes[i].getW());
+	}
+	const __m128 signMask = _mm_set1_ps(-0.0f);
+#endif
+
+	int32_t numCulled = 0;
+	for (const DebugSphereSegment& segment : g_dwg.drawSphereSegments)
+	{
+		int32_t i = 0;
+
+#if VECTORMATH_MODE_SSE
+		for (; i + 4 <= segment.count; i += 4)
+		{
+			const DebugSphere* spheres = segment.spheres + i;
+
+			// position and scale of 4 spheres as x, y, z registers, the 4th loaded float is not used
+			__m128 p0 = _mm_loadu_ps(spheres[0].position);
+			__m128 p1 = _mm_loadu_ps(spheres[1].position);
+			__m128 p2 = _mm_loadu_ps(spheres[2].position);
+			__m128 p3 = _mm_loadu_ps(spheres[3].position);
+			_MM_TRANSPOSE4_PS(p0, p1, p2, p3);
+
+			__m128 s0 = _mm_loadu_ps(spheres[0].scale);
+			__m128 s1 = _mm_loadu_ps(spheres[1].scale);
+			__m128 s2 = _mm_loadu_ps(spheres[2].scale);
+			__m128 s3 = _mm_loadu_ps(spheres[3].scale);
+			_MM_TRANSPOSE4_PS(s0, s1, s2, s3);
+
+			const __m128 radius = _mm_max_ps(_mm_max_ps(_mm_andnot_ps(signMask, s0), _mm_andnot_ps(signMask, s1)), _mm_andnot_ps(signMask, s2));
+			const __m128 minDistance = _mm_xor_ps(radius, signMask);
+
+			int32_t visible = 0xf;
+			if (g_dwg.culling)
+			{
+				__m128 inside = _mm_cmpgt_ps(_mm_add_ps(dwgDot4(p0, p1, p2, planeX[0], planeY[0], planeZ[0]), planeW[0]), minDistance);
+				for (int32_t k = 1; k < 6; ++k)
+				{
+					inside = _mm_and_ps(inside, _mm_cmpgt_ps(_mm_add_ps(dwgDot4(p0, p1, p2, planeX[k], planeY[k], planeZ[k]), planeW[k]), minDistance));
+				}
+				visible = _mm_movemask_ps(inside);
+			}
+
+			if (visible == 0)
+			{
+				numCulled += 4;
+				continue;
+			}
+
+			const __m128 w = _mm_add_ps(dwgDot4(p0, p1, p2, _mm_set1_ps(rowX), _mm_set1_ps(rowY), _mm_set1_ps(rowZ)), _mm_set1_ps(rowW));
+
+			float ws[4], radii[4];
+			_mm_storeu_ps(ws, w);
+			_mm_storeu_ps(radii, radius);
+
+			for (int32_t lane = 0; lane < 4; ++lane)
+			{
+				if (visible & (1 << lane))
+					dwgAddLodSphere(spheres[lane], ws[lane], radii[lane], lodScale);
+				else
+					++numCulled;
+			}
+		}
+#endif
+
+		for (; i < segment.count; ++i)
+		{
+			const DebugSphere& sphere = segment.spheres[i];
+			const float radius = std::max(std::max(fabsf(sphere.scale[0]), fabsf(sphere.scale[1])), fabsf(sphere.scale[2]));
+
+			bool visible = true;
+			for (int32_t k = 0; g_dwg.culling && visible && k < 6; ++k)
+			{
+				const Vector4& plane = planes[k];
+				visible = plane.getX() * sphere.position[0] + plane.getY() * sphere.position[1] + plane.getZ() * sphere.position[2] + plane.getW() > -radius;
+			}
+
+			if (!visible)
+			{
+				++numCulled;
+				continue;
+			}
+
+			const float w = rowX * sphere.position[0] + rowY * sphere.position[1] + rowZ * sphere.position[2] + rowW;
+			dwgAddLodSphere(sphere, w, radius, lodScale);
+		}
+	}
+
+	g_dwg.stats.numCulledSpheres = numCulled;
+	g_dwg.stats.numSpheres -= numCulled;
+
+	g_dwg.stats.numImpostors = (int32_t)g_dwg.lodSpheres[DWG_SPHERE_IMPOSTOR].size();
+	g_dwg.stats.numSphereTriangles = 0;
+	for (int32_t lod = 0; lod <= DWG_SPHERE_IMPOSTOR; ++lod)
+	{
+		g_dwg.stats.numSphereTriangles += (int64_t)g_dwg.lodSpheres[lod].size() * (g_dwg.sphereLods[lod].numIndices / 3);
+	}
+}
+
+#if !DWG_NO_GL
+static void dwgDrawLines(const Matrix4& mvp)
+{
+	const Vector3 colorWhite = { 1.0f, 1.0f, 1.0f };
+
+	glUseProgram(g_dwg.shaderProgram);
+	glUniform3fv(g_dwg.vertexShaderTintLoc, 1, toFloatPtr(colorWhite));
+	glUniformMatrix4fv(g_dwg.vertexShaderMVPLoc, 1, GL_FALSE, (const GLfloat*)&mvp);
+
+	for (DebugLineChunk* chunk : g_dwg.drawLineChunks)
+	{
+		chunk->drawOffset = dwgStreamEnd(chunk->stream);
+	}
+
+	const DebugLineChunk* boundChunk = nullptr;
+
+	for (const DebugLineRange& range : g_dwg.drawLineRanges)
+	{
+		const DebugLineChunk* chunk = range.chunk;
+
+		if (chunk != boundChunk)
+		{
+			glBindBuffer(GL_ARRAY_BUFFER, chunk->stream.buffer);
+
+			// todo: do I need to call it here? I don't remember...
+			glEnableVertexAttribArray(g_dwg.vertexShaderPositionLoc);
+			glVertexAttribPointer(g_dwg.vertexShaderPositionLoc, 3, GL_FLOAT, GL_FALSE,
+				sizeof(DebugVertex), (void*)chunk->drawOffset);
+			glEnableVertexAttribArray(g_dwg.vertexShaderColorLoc);
+			glVertexAttribPointer(g_dwg.vertexShaderColorLoc, 3, GL_FLOAT, GL_FALSE,
+				sizeof(DebugVertex), (void*)(chunk->drawOffset + sizeof(float) * 3));
+
+			boundChunk = chunk;
+		}
+
+		glDrawArrays(GL_LINES, range.first, range.count);
+		g_dwg.stats.numDrawCalls += 1;
+	}
+
+	for (DebugLineChunk* chunk : g_dwg.drawLineChunks)
+	{
+		dwgStreamFence(chunk->stream);
+	}
+}
+
+// draws the mesh once per sphere, instanceLocs are the locations of iPosition, iScale, iRotation and iColor
+static void dwgDrawSphereInstances(const GLuint* instanceLocs, const std::vector<DebugSphere>& spheres, const DebugSphereLod& mesh)
+{
+	if (spheres.empty())
+		return;
+
+	const void* indices = (void*)(sizeof(uint16_t) * mesh.firstIndex);
+
+	if (g_dwg.instancing)
+	{
+		// the buffer is orphaned by every upload, so we don't wait for the previous draw
+		glBindBuffer(GL_ARRAY_BUFFER, g_dwg.instanceBufferSpheres);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(DebugSphere) * spheres.size(), spheres.data(), GL_STREAM_DRAW);
+
+		glVertexAttribPointer(instanceLocs[0], 3, GL_FLOAT, GL_FALSE,
+			sizeof(DebugSphere), (void*)offsetof(DebugSphere, position));
+		glVertexAttribPointer(instanceLocs[1], 3, GL_FLOAT, GL_FALSE,
+			sizeof(DebugSphere), (void*)offsetof(DebugSphere, scale));
+		glVertexAttribPointer(instanceLocs[2], 4, GL_SHORT, GL_TRUE,
+			sizeof(DebugSphere), (void*)offsetof(DebugSphere, rotation));
+		glVertexAttribPointer(instanceLocs[3], 4, GL_UNSIGNED_BYTE, GL_TRUE,
+			sizeof(DebugSphere), (void*)offsetof(DebugSphere, color));
+
+		for (int32_t i = 0; i < 4; ++i)
+		{
+			glEnableVertexAttribArray(instanceLocs[i]);
+			glVertexAttribDivisor(instanceLocs[i], 1);
+		}
+
+		glDrawElementsInstanced(GL_TRIANGLES, mesh.numIndices, GL_UNSIGNED_SHORT, indices, (GLsizei)spheres.size());
+		g_dwg.stats.numDrawCalls += 1;
+
+		// lines use the same attribute locations without divisor
+		for (int32_t i = 0; i < 4; ++i)
+		{
+			glVertexAttribDivisor(instanceLocs[i], 0);
+			glDisableVertexAttribArray(instanceLocs[i]);
+		}
+	}
+	else
+	{
+		// pseudo instancing, instance attributes are constant vertex attributes (cheaper than uniforms)
+		for (const DebugSphere& sphere : spheres)
+		{
+			glVertexAttrib3fv(instanceLocs[0], sphere.position);
+			glVertexAttrib3fv(instanceLocs[1], sphere.scale);
+			glVertexAttrib4Nsv(instanceLocs[2], sphere.rotation);
+			glVertexAttrib4Nubv(instanceLocs[3], sphere.color);
+
+			glDrawElements(GL_TRIANGLES, mesh.numIndices, GL_UNSIGNED_SHORT, indices);
+		}
+
+		g_dwg.stats.numDrawCalls += (int32_t)spheres.size();
+	}
+}
+
+// one instanced draw per LOD, then the impostors
+static void dwgDrawSpheres(const Matrix4& mvp, const Vector3& eye)
+{
+	glBindBuffer(GL_ARRAY_BUFFER, g_dwg.vertexBufferSphereMesh);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, g_dwg.indexBufferSphereMesh);
+
+	glUseProgram(g_dwg.sphereShaderProgram);
+	glUniformMatrix4fv(g_dwg.sphereShaderMVPLoc, 1, GL_FALSE, (const GLfloat*)&mvp);
+
+	glEnableVertexAttribArray(g_dwg.sphereShaderPositionLoc);
+	glVertexAttribPointer(g_dwg.sphereShaderPositionLoc, 3, GL_FLOAT, GL_FALSE,
+		sizeof(DebugVertex), (void*)0);
+	glEnableVertexAttribArray(g_dwg.sphereShaderColorLoc);
+	glVertexAttribPointer(g_dwg.sphereShaderColorLoc, 3, GL_FLOAT, GL_FALSE,
+		sizeof(DebugVertex), (void*)(sizeof(float) * 3));
+
+	const GLuint sphereInstanceLocs[] = { g_dwg.sphereShaderInstancePositionLoc, g_dwg.sphereShaderInstanceScaleLoc,
+		g_dwg.sphereShaderInstanceRotationLoc, g_dwg.sphereShaderInstanceColorLoc };
+
+	for (int32_t lod = 0; lod < DWG_SPHERE_LODS; ++lod)
+	{
+		dwgDrawSphereInstances(sphereInstanceLocs, g_dwg.lodSpheres[lod], g_dwg.sphereLods[lod]);
+	}
+
+	if (g_dwg.lodSpheres[DWG_SPHERE_IMPOSTOR].empty())
+		return;
+
+	// the impostor program has no vCol, its location could be one of the constant instance attributes
+	glDisableVertexAttribArray(g_dwg.sphereShaderColorLoc);
+
+	glUseProgram(g_dwg.impostorShaderProgram);
+	glUniformMatrix4fv(g_dwg.impostorShaderMVPLoc, 1, GL_FALSE, (const GLfloat*)&mvp);
+	glUniform3fv(g_dwg.impostorShaderEyeLoc, 1, toFloatPtr(eye));
+
+	glBindBuffer(GL_ARRAY_BUFFER, g_dwg.vertexBufferSphereMesh);
+	glEnableVertexAttribArray(g_dwg.impostorShaderPositionLoc);
+	glVertexAttribPointer(g_dwg.impostorShaderPositionLoc, 3, GL_FLOAT, GL_FALSE,
+		sizeof(DebugVertex), (void*)0);
+
+	const GLuint impostorInstanceLocs[] = { g_dwg.impostorShaderInstancePositionLoc, g_dwg.impostorShaderInstanceScaleLoc,
+		g_dwg.impostorShaderInstanceRotationLoc, g_dwg.impostorShaderInstanceColorLoc };
+
+	dwgDrawSphereInstances(impostorInstanceLocs, g_dwg.lodSpheres[DWG_SPHERE_IMPOSTOR], g_dwg.sphereLods[DWG_SPHERE_IMPOSTOR]);
 }
+#endif
 
-void dwgDebugSphere(const Vector3& position, const Vector3& scale, const Vector3& color)
+// the software renderer reads the merged segments directly from the chunks
+static void dwgRenderSoftware(const Matrix4& mvp, int32_t width, int32_t height)
+{
+	SoftwareRenderer& renderer = g_dwg.softwareRenderer;
+	dwgSoftwareBeginFrame(renderer, width, height, mvp);
+
+	for (const DebugLineRange& range : g_dwg.drawLineRanges)
+	{
+		dwgSoftwareAddLines(renderer, range.chunk->vertices + range.first, range.count);
+	}
+
+	for (int32_t lod = 0; lod <= DWG_SPHERE_IMPOSTOR; ++lod)
+	{
+		dwgSoftwareAddSpheres(renderer, g_dwg.lodSpheres[lod].data(), (int32_t)g_dwg.lodSpheres[lod].size(), lod);
+	}
+
+	dwgSoftwareEndFrame(renderer);
+
+	// already top-down rows, no read back
+	if (dwgCaptureActive())
+	{
+		dwgCaptureFrame(renderer.color.data(), width, height, false);
+	}
+}
+
+static void dwgUpdateStats()
+{
+	DwGDebugStats& stats = g_dwg.stats;
+
+	stats.numLines = 0;
+	for (const DebugLineSegment& segment : g_dwg.drawLineSegments)
+	{
+		stats.numLines += segment.count / 2;
+	}
+
+	stats.numSpheres = 0;
+	for (const DebugSphereSegment& segment : g_dwg.drawSphereSegments)
+	{
+		stats.numSpheres += segment.count;
+	}
+
+	// numSphereChunks is counted by dwgMergeRecorders, it walks the recorders anyway
+	stats.numLineChunks = (int32_t)g_dwg.lineChunks.size();
+
+	stats.maxLines = DWG_MAX(stats.maxLines, stats.numLines);
+	stats.maxSpheres = DWG_MAX(stats.maxSpheres, stats.numSpheres);
+}
+
+// clears the recorded data, releases recorders of threads that exited
+static void dwgResetRecorders()
+{
+	for (size_t i = 0; i < g_dwg.recorders.size(); )
+	{
+		DebugRecorder& recorder = *g_dwg.recorders[i];
+
+		for (DebugLineChunk* chunk : recorder.lineChunks)
+		{
+			if (chunk->overflow)
+				recorder.spareLineChunks.push_back(chunk);
+		}
+		recorder.lineChunks.clear();
+		recorder.lineSegments.clear();
+		recorder.lineChunk = nullptr;
+
+		recorder.numSphereChunks = 0;
+		recorder.sphereSegments.clear();
+		recorder.sphereChunk = nullptr;
+
+		recorder.sortKey = 0;
+
+		if (g_dwg.recorders[i].use_count() == 1)
+		{
+			g_dwg.recorders[i] = g_dwg.recorders.back();
+			g_dwg.recorders.pop_back();
+		}
+		else
+		{
+			++i;
+		}
+	}
+}
+
+void dwgRender(const Matrix4& camera, const float fov)
+{
+	dwgMergeRecorders();
+	dwgUpdateStats();
+	g_dwg.stats.numDrawCalls = 0;
+
+	// render current frame
+	{
+		float ratio;
+		int width, height;
+
+		width = g_dwg.width;
+		height = g_dwg.height;
+
+#if !DWG_NO_GL
+		if (!g_dwg.software && !(g_dwg.flags & DWG_APP_HEADLESS))
+		{
+			glfwGetFramebufferSize(g_dwg.window, &width, &height);
+		}
+#endif
+		ratio = width / (float)height;
+
+		const float viewHalfLength = 10.0f;
+		Matrix4 p = Matrix4::perspective(fov * (float)DWG_PI / 360.0f, ratio, DWG_NEAR_PLANE, DWG_FAR_PLANE);
+		Matrix4 mvp = p * camera;
+
+		Vector4 frustumPlanes[6];
+		dwgFrustumPlanes(mvp, frustumPlanes);
+		dwgCullLines(frustumPlanes);
+		dwgSelectSpheres(mvp, frustumPlanes, 0.5f * height * p.getCol1().getY());
+
+		if (g_dwg.software)
+		{
+			dwgRenderSoftware(mvp, width, height);
+		}
+#if !DWG_NO_GL
+		else
+		{
+			glViewport(0, 0, width, height);
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+			dwgDrawLines(mvp);
+			dwgDrawSpheres(mvp, inverse(camera).getTranslation());
+
+			if (dwgCaptureActive())
+			{
+				dwgCaptureRenderedFrame(width, height);
+			}
+
+			// headless frame is in the framebuffer object, nothing to present
+			if (!(g_dwg.flags & DWG_APP_HEADLESS))
+			{
+				glfwSwapBuffers(g_dwg.window);
+			}
+			glfwPollEvents();
+		}
+#endif
+	}
+
+	// clear stuff for the next update + calculate delta time
+	{
+		dwgResetRecorders();
+		dwgPrepareLineChunks();
+
+		const double nextTime = dwgTime();
+		g_dwg.deltaTime = DWG_MIN((float)(nextTime - g_dwg.globalTime), 0.1f);	// clamp max time to 0.1, so we have something predictable once placing breakpoint in code
+		g_dwg.globalTime = nextTime;
+	}
+}
+
+void dwgReleaseApp()
+{
+	dwgStopCapture();
+
+#if !DWG_NO_GL
+	if (!g_dwg.software)
+	{
+		for (int32_t i = 0; i < DWG_STREAM_FRAMES; ++i)
+		{
+			glDeleteBuffers(1, &g_dwg.captureBuffers[i]);
+			g_dwg.captureBuffers[i] = 0;
+		}
+
+		glDeleteFramebuffers(1, &g_dwg.framebuffer);
+		glDeleteRenderbuffers(1, &g_dwg.colorRenderbuffer);
+		glDeleteRenderbuffers(1, &g_dwg.depthRenderbuffer);
+		g_dwg.framebuffer = 0;
+		g_dwg.colorRenderbuffer = 0;
+		g_dwg.depthRenderbuffer = 0;
+	}
+#endif
+
+	// recorders still referenced by their threads only keep the memory of overflow and sphere chunks
+	dwgTakeNewRecorders();
+	dwgResetRecorders();
+	g_dwg.recorders.clear();
+
+	for (DebugLineChunk* chunk : g_dwg.lineChunks)
+	{
+		if (g_dwg.software)
+		{
+			delete[] chunk->vertices;
+		}
+#if !DWG_NO_GL
+		else
+		{
+			dwgStreamRelease(chunk->stream);
+		}
+#endif
+		delete chunk;
+	}
+	g_dwg.lineChunks.clear();
+	g_dwg.readyLineChunks.clear();
+
+	g_dwg.sphereVertices.clear();
+	g_dwg.sphereIndices.clear();
+
+#if !DWG_NO_GL
+	if (!g_dwg.software)
+	{
+		glDeleteBuffers(1, &g_dwg.instanceBufferSpheres);
+
+		glfwDestroyWindow(g_dwg.window);
+		glfwTerminate();
+	}
+#endif
+}
+
+float dwgDeltaTime()
+{
+	return g_dwg.deltaTime;
+}
+
+double dwgGlobalTime()
+{
+	return g_dwg.globalTime;
+}
+
+const DwGDebugStats& dwgDebugStats()
+{
+	return g_dwg.stats;
+}
+
+void dwgDebugStableOrder(bool stable)
+{
+	g_dwg.stableOrder = stable;
+}
+
+void dwgDebugSphereImpostors(bool impostors)
+{
+	g_dwg.impostors = impostors;
+}
+
+void dwgDebugFrustumCulling(bool culling)
+{
+	g_dwg.culling = culling;
+}
+
+void dwgDebugSortKey(int32_t key)
+{
+	DebugRecorder& recorder = dwgRecorder();
+	if (recorder.sortKey == key)
+		return;
+
+	recorder.sortKey = key;
+
+	// following primitives go to new segments
+	if (recorder.lineChunk)
+	{
+		recorder.lineSegments.push_back({ key, recorder.lineChunk, recorder.lineChunk->numVertices, 0 });
+	}
+
+	if (recorder.sphereChunk)
+	{
+		recorder.sphereSegments.push_back({ key, recorder.sphereChunk->spheres + recorder.sphereChunk->numSpheres, 0 });
+	}
+}
+
+// next chunk of this frame, takes a mapped one from the pool when there is any left
+static DebugLineChunk* dwgNextLineChunk(DebugRecorder& recorder)
+{
+	DebugLineChunk* chunk = nullptr;
+
+	const int32_t ready = g_dwg.nextReadyLineChunk.fetch_add(1);
+	if (ready < (int32_t)g_dwg.readyLineChunks.size())
+	{
+		chunk = g_dwg.readyLineChunks[ready];
+	}
+	else if (std::this_thread::get_id() == g_dwg.renderThread)
+	{
+		chunk = dwgMapFreeLineChunk();
+	}
+	else if (!recorder.spareLineChunks.empty())
+	{
+		chunk = recorder.spareLineChunks.back();
+		recorder.spareLineChunks.pop_back();
+	}
+	else
+	{
+		// overflow chunk, GL can be used only by the render thread
+		chunk = new DebugLineChunk();
+		chunk->vertices = new DebugVertex[DWG_LINE_CHUNK_VERTICES];
+		chunk->overflow = true;
+	}
+
+	chunk->numVertices = 0;
+
+	recorder.lineChunks.push_back(chunk);
+	recorder.lineSegments.push_back({ recorder.sortKey, chunk, 0, 0 });
+	recorder.lineChunk = chunk;
+	return chunk;
+}
+
+static DebugSphereChunk* dwgNextSphereChunk(DebugRecorder& recorder)
+{
+	if (recorder.numSphereChunks == (int32_t)recorder.sphereChunks.size())
+	{
+		recorder.sphereChunks.push_back(new DebugSphereChunk());
+	}
+
+	DebugSphereChunk* chunk = recorder.sphereChunks[recorder.numSphereChunks++];
+	chunk->numSpheres = 0;
+
+	recorder.sphereSegments.push_back({ recorder.sortKey, chunk->spheres, 0 });
+	recorder.sphereChunk = chunk;
+	return chunk;
+}
+
+static inline void dwgExpandBounds(float* boundsMin, float* boundsMax, float x, float y, float z)
+{
+	boundsMin[0] = std::min(boundsMin[0], x);
+	boundsMin[1] = std::min(boundsMin[1], y);
+	boundsMin[2] = std::min(boundsMin[2], z);
+	boundsMax[0] = std::max(boundsMax[0], x);
+	boundsMax[1] = std::max(boundsMax[1], y);
+	boundsMax[2] = std::max(boundsMax[2], z);
+}
+
+void dwgDebugLine(const Vector3& start, const Vector3& end, const Vector3& color)
+{
+	DebugRecorder& recorder = dwgRecorder();
+
+	DebugLineChunk* chunk = recorder.lineChunk;
+	if (chunk == nullptr || chunk->numVertices + 2 > DWG_LINE_CHUNK_VERTICES)
+	{
+		chunk = dwgNextLineChunk(recorder);
+	}
+
+	assert(chunk->vertices != nullptr);
+
+	// written directly to the mapped vertex buffer
+	DebugVertex* v = chunk->vertices + chunk->numVertices;
+
+	v->x = start.getX();
+	v->y = start.getY();
+	v->z = start.getZ();
+
+	v->r = color.getX();
+	v->g = color.getY();
+	v->b = color.getZ();
+
+	++v;
+
+	v->x = end.getX();
+	v->y = end.getY();
+	v->z = end.getZ();
+
+	v->r = color.getX();
+	v->g = color.getY();
+	v->b = color.getZ();
+
+	// bounds of the block for the frustum culling, the first line of the block resets them
+	// (from the arguments, the mapped memory is slow to read)
+	const int32_t block = chunk->numVertices / DWG_LINE_CULL_BLOCK_VERTICES;
+	float* blockMin = chunk->blockMin[block];
+	float* blockMax = chunk->blockMax[block];
+	if (chunk->numVertices % DWG_LINE_CULL_BLOCK_VERTICES == 0)
+	{
+		blockMin[0] = blockMax[0] = start.getX();
+		blockMin[1] = blockMax[1] = start.getY();
+		blockMin[2] = blockMax[2] = start.getZ();
+	}
+	dwgExpandBounds(blockMin, blockMax, start.getX(), start.getY(), start.getZ());
+	dwgExpandBounds(blockMin, blockMax, end.getX(), end.getY(), end.getZ());
+
+	chunk->numVertices += 2;
+	recorder.lineSegments.back().count += 2;
+}
+
+static uint8_t dwgPackUnorm8(const float value)
+{
+	return (uint8_t)(clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+}
+
+static int16_t dwgPackSnorm16(const float value)
+{
+	const float scaled = clamp(value, -1.0f, 1.0f) * 32767.0f;
+	return (int16_t)(scaled < 0.0f ? scaled - 0.5f : scaled + 0.5f);
+}
+
+void dwgDebugSphere(const Vector3& position, const Quat& rotation, const Vector3& scale, const Vector3& color)
 {
-	assert(g_dwg.numSpheres + 1 < DWG_MAX_DEBUG_SPHERES && g_dwg.spheres != nullptr);
+	DebugRecorder& recorder = dwgRecorder();
+
+	DebugSphereChunk* chunk = recorder.sphereChunk;
+	if (chunk == nullptr || chunk->numSpheres == DWG_SPHERE_CHUNK_SPHERES)
+	{
+		chunk = dwgNextSphereChunk(recorder);
+	}
+
+	DebugSphere& sphere = chunk->spheres[chunk->numSpheres];
 
-	DebugSphere& sphere = g_dwg.spheres[g_dwg.numSpheres];
-	sphere.worldLocation = Matrix4::translation(position) * Matrix4::scale(scale);
-	sphere.color = color;
+	sphere.position[0] = position.getX();
+	sphere.position[1] = position.getY();
+	sphere.position[2] = position.getZ();
 
-	g_dwg.numSpheres += 1;
+	sphere.scale[0] = scale.getX();
+	sphere.scale[1] = scale.getY();
+	sphere.scale[2] = scale.getZ();
+
+	sphere.rotation[0] = dwgPackSnorm16(rotation.getX());
+	sphere.rotation[1] = dwgPackSnorm16(rotation.getY());
+	sphere.rotation[2] = dwgPackSnorm16(rotation.getZ());
+	sphere.rotation[3] = dwgPackSnorm16(rotation.getW());
+
+	sphere.color[0] = dwgPackUnorm8(color.getX());
+	sphere.color[1] = dwgPackUnorm8(color.getY());
+	sphere.color[2] = dwgPackUnorm8(color.getZ());
+	sphere.color[3] = 255;
+
+	chunk->numSpheres += 1;
+	recorder.sphereSegments.back().count += 1;
+}
+
+void dwgDebugSphere(const Vector3& position, const Vector3& scale, const Vector3& color)
+{
+	dwgDebugSphere(position, Quat::identity(), scale, color);
 }
 
 void dwgDebugSphere(const Matrix4& worldLocation, const Vector3& color)
 {
-	assert(g_dwg.numSpheres + 1 < DWG_MAX_DEBUG_SPHERES && g_dwg.spheres != nullptr);
+	// split into translation, rotation and scale (shear is lost)
+	const Matrix3 upper = worldLocation.getUpper3x3();
+	Vector3 axes[3] = { upper.getCol0(), upper.getCol1(), upper.getCol2() };
+	float scale[3] = { length(axes[0]), length(axes[1]), length(axes[2]) };
+	int32_t numFlat = 0;
+	int32_t flat = 0;
+	for (int32_t k = 0; k < 3; ++k)
+	{
+		if (scale[k] > 0.0f)
+		{
+			axes[k] /= scale[k];
+		}
+		else
+		{
+			numFlat += 1;
+			flat = k;
+		}
+	}
+
+	// zero scale axes have no direction, complete them to a right handed basis
+	if (numFlat == 1)
+	{
+		const Vector3 completion = cross(axes[(flat + 1) % 3], axes[(flat + 2) % 3]);
+		const float completionLength = length(completion);
+		if (completionLength > 0.0f)
+		{
+			axes[flat] = completion / completionLength;
+		}
+		else
+		{
+			// the other two axes are parallel, keep only one of them
+			scale[(flat + 2) % 3] = 0.0f;
+			numFlat = 2;
+		}
+	}
+	if (numFlat == 2)
+	{
+		int32_t kept = 0;
+		while (!(scale[kept] > 0.0f))
+		{
+			kept += 1;
+		}
+		const Vector3& a = axes[kept];
+		const Vector3 b = normalize(cross(a, fabsf(a.getX()) < 0.9f ? Vector3::xAxis() : Vector3::yAxis()));
+		axes[(kept + 1) % 3] = b;
+		axes[(kept + 2) % 3] = cross(a, b);
+	}
+	if (numFlat == 3)
+	{
+		axes[0] = Vector3::xAxis();
+		axes[1] = Vector3::yAxis();
+		axes[2] = Vector3::zAxis();
+	}
+
+	// mirrored transform, flip one axis so the rest is a rotation
+	if ((float)determinant(upper) < 0.0f)
+	{
+		scale[0] = -scale[0];
+		axes[0] = -axes[0];
+	}
+
+	const Matrix3 rotation(axes[0], axes[1], axes[2]);
+	dwgDebugSphere(worldLocation.getTranslation(), normalize(Quat(rotation)), Vector3(scale[0], scale[1], scale[2]), color);
+}
+
+void dwgDebugBox(const Vector3& position, const Quat& rotation, const Vector3& halfExtents, const Vector3& color)
+{
+	const Matrix3 axes(rotation);
+	const Vector3 x = axes.getCol0() * halfExtents.getX();
+	const Vector3 y = axes.getCol1() * halfExtents.getY();
+	const Vector3 z = axes.getCol2() * halfExtents.getZ();
+
+	// corner k has the signs of bits 0, 1 and 2 of k
+	Vector3 corners[8];
+	for (int32_t k = 0; k < 8; ++k)
+	{
+		corners[k] = position + (k & 1 ? x : -x) + (k & 2 ? y : -y) + (k & 4 ? z : -z);
+	}
+
+	// every edge connects corners that differ in one bit
+	for (int32_t k = 0; k < 8; ++k)
+	{
+		for (int32_t bit = 1; bit < 8; bit <<= 1)
+		{
+			if (!(k & bit))
+				dwgDebugLine(corners[k], corners[k | bit], color);
+		}
+	}
+}
+
+void dwgDebugCapsule(const Vector3& a, const Vector3& b, float radius, const Vector3& color)
+{
+	dwgDebugSphere(a, Vector3(radius), color);
+	dwgDebugSphere(b, Vector3(radius), color);
+
+	// any two axes perpendicular to the segment
+	const Vector3 axis = b - a;
+	if (lengthSqr(axis) <= 0.f)
+		return;
+
+	const Vector3 helper = fabsf(axis.getZ()) < 0.9f * length(axis) ? Vector3(0.f, 0.f, 1.f) : Vector3(1.f, 0.f, 0.f);
+	const Vector3 side0 = normalize(cross(axis, helper)) * radius;
+	const Vector3 side1 = normalize(cross(axis, side0)) * radius;
+
+	dwgDebugLine(a + side0, b + side0, color);
+	dwgDebugLine(a - side0, b - side0, color);
+	dwgDebugLine(a + side1, b + side1, color);
+	dwgDebugLine(a - side1, b - side1, color);
+}
+
+void dwgDebugPlane(const Vector3& normal, float offset, int32_t size, const Vector3& color)
+{
+	if (lengthSqr(normal) <= 0.f || size <= 0)
+		return;
 
-	DebugSphere& sphere = g_dwg.spheres[g_dwg.numSpheres];
-	sphere.worldLocation = worldLocation;
-	sphere.color = color;
+	const Vector3 n = normalize(normal);
+	const Vector3 helper = fabsf(n.getZ()) < 0.9f ? Vector3(0.f, 0.f, 1.f) : Vector3(1.f, 0.f, 0.f);
+	const Vector3 u = normalize(cross(n, helper));
+	const Vector3 v = cross(n, u);
+	const Vector3 center = n * (offset / length(normal));
+	const float half = 0.5f * (float)size;
 
-	g_dwg.numSpheres += 1;
+	for (int32_t i = 0; i <= size; ++i)
+	{
+		const float t = (float)i - half;
+		dwgDebugLine(center + u * t - v * half, center + u * t + v * half, color);
+		dwgDebugLine(center + v * t - u * half, center + v * t + u * half, color);
+	}
 }
@@ -2,11 +2,33 @@
 
 #include <stdint.h>
 #include "vectormath.hpp"
+#include "dwgFrameCapture.h"
 
 #define DWG_PI 3.14159265358979323846
 
+// dwgInitApp flags
+#define DWG_APP_HEADLESS 0x1	// hidden window, renders to offscreen framebuffer of width x height without vsync
+#define DWG_APP_SOFTWARE 0x2	// no window nor OpenGL, the CPU rasterizer renders width x height (see dwgSoftwareRenderer.h), always on in DWG_NO_GL builds
+
+// debug draw counters, updated by dwgRender
+struct DwGDebugStats
+{
+	int32_t numLines = 0;	// drawn by the last dwgRender, after the frustum culling
+	int32_t numSpheres = 0;
+	int32_t numCulledLines = 0;	// outside of the view frustum, culled lines are not drawn, culled spheres not uploaded
+	int32_t numCulledSpheres = 0;
+	int32_t numDrawCalls = 0;
+	int64_t numSphereTriangles = 0;	// of the sphere meshes after the LOD selection (2 per impostor)
+	int32_t numImpostors = 0;	// spheres drawn as impostors
+
+	int32_t maxLines = 0;	// high-water marks since the start of app
+	int32_t maxSpheres = 0;
+	int32_t numLineChunks = 0;	// allocated chunks, they are never released before dwgReleaseApp
+	int32_t numSphereChunks = 0;
+};
+
 // call once at the beginning of app
-bool dwgInitApp(int32_t width, int32_t height, const char* title);
+bool dwgInitApp(int32_t width, int32_t height, const char* title, uint32_t flags = 0);
 
 // call inside while loop condition
 bool dwgShouldClose();
@@ -23,11 +45,51 @@ float dwgDeltaTime();
 // returns global time passed, since the beginning of app
 double dwgGlobalTime();
 
+// writes every rendered frame to pathFormat with the frame index, e.g. "capture/frame_%05d.png"
+// frames are read back asynchronously and written by a background thread (see dwgFrameCapture.h)
+bool dwgStartCapture(const char* pathFormat, CaptureFormat format);
+
+// writes the frames that are still pending, called by dwgReleaseApp too
+void dwgStopCapture();
+
+// returns debug draw counters of the last frame
+const DwGDebugStats& dwgDebugStats();
+
+// debug lines and spheres can be added from any thread, every thread records to its own buffers
+// the recorded primitives are merged by dwgRender, no thread may add any while dwgRender runs
+
+// draw the primitives sorted by the keys given to dwgDebugSortKey, otherwise they are grouped by thread
+void dwgDebugStableOrder(bool stable);
+
+// primitives added by the calling thread after this call get the key, keys are reset to 0 by dwgRender
+// e.g. the begin index of a parallel for chunk gives the same draw order with any number of threads
+void dwgDebugSortKey(int32_t key);
+
+// draw spheres as impostors, a quad per sphere and the exact surface is computed per pixel (for scenes with 100k+ spheres)
+// spheres that cross the near plane still use the meshes
+void dwgDebugSphereImpostors(bool impostors);
+
+// skip primitives outside of the view frustum before they are uploaded (on by default)
+// spheres are tested one by one, lines by blocks of 256 lines recorded in a row (record nearby lines together)
+void dwgDebugFrustumCulling(bool culling);
+
 // add debug line to this frame
 void dwgDebugLine(const Vector3& start, const Vector3& end, const Vector3& color);
 
 // add debug sphere to this frame
 void dwgDebugSphere(const Vector3& position, const Vector3& scale, const Vector3& color);
 
-// add debug sphere to this frame
+// add rotated debug sphere (ellipsoid) to this frame
+void dwgDebugSphere(const Vector3& position, const Quat& rotation, const Vector3& scale, const Vector3& color);
+
+// add debug sphere to this frame, the matrix is split into translation, rotation and scale
 void dwgDebugSphere(const Matrix4& worldLocation, const Vector3& color);
+
+// add the 12 edges of a rotated box to this frame
+void dwgDebugBox(const Vector3& position, const Quat& rotation, const Vector3& halfExtents, const Vector3& color);
+
+// add capsule (segment from a to b with a radius) to this frame, spheres at the ends and 4 lines along the sides
+void dwgDebugCapsule(const Vector3& a, const Vector3& b, float radius, const Vector3& color);
+
+// add plane (dot(normal, point) = offset) to this frame as a grid of lines 1 unit apart, size x size around the point closest to the origin
+void dwgDebugPlane(const Vector3& normal, float offset, int32_t size, const Vector3& color);
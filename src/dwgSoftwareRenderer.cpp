@@ -0,0 +1,702 @@
+#include "dwgSoftwareRenderer.h"
+#include "dwgParallel.h"
+#include <math.h>
+#include <string.h>
+#include <chrono>
+
+#if VECTORMATH_MODE_SSE
+#include <emmintrin.h>
+#endif
+
+struct RasterTile
+{
+	int32_t x0, y0;	// first pixel
+	int32_t x1, y1;	// one past the last pixel
+};
+
+static float dwgMillisecondsSince(const std::chrono::steady_clock::time_point& start)
+{
+	return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static inline uint32_t dwgPackColor(float r, float g, float b)
+{
+	const uint32_t ri = (uint32_t)(fminf(fmaxf(r, 0.f), 1.f) * 255.f + 0.5f);
+	const uint32_t gi = (uint32_t)(fminf(fmaxf(g, 0.f), 1.f) * 255.f + 0.5f);
+	const uint32_t bi = (uint32_t)(fminf(fmaxf(b, 0.f), 1.f) * 255.f + 0.5f);
+	return ri | (gi << 8) | (bi << 16) | 0xff000000u;
+}
+
+static inline void dwgStoreColor(uint8_t* pixel, uint32_t color)
+{
+	pixel[0] = (uint8_t)color;
+	pixel[1] = (uint8_t)(color >> 8);
+	pixel[2] = (uint8_t)(color >> 16);
+	pixel[3] = (uint8_t)(color >> 24);
+}
+
+static inline RasterVertex dwgProject(const SoftwareRenderer& renderer, const Vector4& clip, float r, float g, float b)
+{
+	const float invW = 1.f / clip.getW();
+
+	RasterVertex v;
+	v.x = (clip.getX() * invW + 1.f) * 0.5f * renderer.width;
+	v.y = (1.f - clip.getY() * invW) * 0.5f * renderer.height;
+	v.z = (clip.getZ() * invW + 1.f) * 0.5f;
+	v.r = r;
+	v.g = g;
+	v.b = b;
+	return v;
+}
+
+// tiles overlapped by the screen rectangle, returns false when it's outside of the screen
+static bool dwgTileBounds(const SoftwareRenderer& renderer, float minX, float minY, float maxX, float maxY,
+	int32_t& minTileX, int32_t& minTileY, int32_t& maxTileX, int32_t& maxTileY)
+{
+	if (maxX < 0.f || maxY < 0.f || minX >= renderer.width || minY >= renderer.height)
+		return false;
+
+	minTileX = (int32_t)fmaxf(minX, 0.f) / DWG_SOFTWARE_TILE_SIZE;
+	minTileY = (int32_t)fmaxf(minY, 0.f) / DWG_SOFTWARE_TILE_SIZE;
+	maxTileX = (int32_t)fminf(maxX, (float)(renderer.width - 1)) / DWG_SOFTWARE_TILE_SIZE;
+	maxTileY = (int32_t)fminf(maxY, (float)(renderer.height - 1)) / DWG_SOFTWARE_TILE_SIZE;
+	return true;
+}
+
+// clips the line by the near plane (z > -w, like OpenGL) and projects it
+static void dwgSetupLine(const SoftwareRenderer& renderer, const DebugVertex& a, const DebugVertex& b, SoftwareLine& line)
+{
+	line.minTileX = 0;
+	line.maxTileX = -1;
+
+	Vector4 clipA = renderer.mvp * Vector4(a.x, a.y, a.z, 1.f);
+	Vector4 clipB = renderer.mvp * Vector4(b.x, b.y, b.z, 1.f);
+
+	const float da = clipA.getZ() + clipA.getW();
+	const float db = clipB.getZ() + clipB.getW();
+	if (da <= 0.f && db <= 0.f)
+		return;
+
+	float colorA[3] = { a.r, a.g, a.b };
+	float colorB[3] = { b.r, b.g, b.b };
+
+	if (da <= 0.f || db <= 0.f)
+	{
+		const float t = da / (da - db);
+		const Vector4 clip = lerp(t, clipA, clipB);
+		float color[3];
+		for (int32_t k = 0; k < 3; ++k)
+		{
+			color[k] = colorA[k] + (colorB[k] - colorA[k]) * t;
+		}
+
+		if (da <= 0.f)
+		{
+			clipA = clip;
+			memcpy(colorA, color, sizeof(color));
+		}
+		else
+		{
+			clipB = clip;
+			memcpy(colorB, color, sizeof(color));
+		}
+	}
+
+	const RasterVertex va = dwgProject(renderer, clipA, colorA[0], colorA[1], colorA[2]);
+	const RasterVertex vb = dwgProject(renderer, clipB, colorB[0], colorB[1], colorB[2]);
+
+	line.x0 = va.x;
+	line.y0 = va.y;
+	line.z0 = va.z;
+	line.x1 = vb.x;
+	line.y1 = vb.y;
+	line.z1 = vb.z;
+	memcpy(line.color0, colorA, sizeof(colorA));
+	memcpy(line.color1, colorB, sizeof(colorB));
+
+	if (!dwgTileBounds(renderer, fminf(va.x, vb.x), fminf(va.y, vb.y), fmaxf(va.x, vb.x), fmaxf(va.y, vb.y),
+		line.minTileX, line.minTileY, line.maxTileX, line.maxTileY))
+	{
+		line.minTileX = 0;
+		line.maxTileX = -1;
+	}
+}
+
+static void dwgSetupSphere(const SoftwareRenderer& renderer, const DebugSphere& sphere, int32_t lod, SoftwareSphere& out)
+{
+	out.lod = lod;
+	out.minTileX = 0;
+	out.maxTileX = -1;
+	out.firstTriangle = 0;
+	out.numTriangles = 0;
+
+	const Vector3 position(sphere.position[0], sphere.position[1], sphere.position[2]);
+	const Vector3 scale(sphere.scale[0], sphere.scale[1], sphere.scale[2]);
+	const Quat rotation = normalize(Quat((float)sphere.rotation[0], (float)sphere.rotation[1], (float)sphere.rotation[2], (float)sphere.rotation[3]));
+
+	out.transform = renderer.mvp * Matrix4(rotation, position) * Matrix4::scale(scale);
+	out.frontSign = sphere.scale[0] * sphere.scale[1] * sphere.scale[2] < 0.f ? -1.f : 1.f;
+	for (int32_t k = 0; k < 3; ++k)
+	{
+		out.color[k] = sphere.color[k] / 255.f;
+	}
+
+	// screen bounds of the unit box around the mesh
+	float minX = 1e30f;
+	float minY = 1e30f;
+	float maxX = -1e30f;
+	float maxY = -1e30f;
+	int32_t numBehind = 0;
+
+	for (int32_t corner = 0; corner < 8; ++corner)
+	{
+		const Vector4 clip = out.transform * Vector4(corner & 1 ? 1.f : -1.f, corner & 2 ? 1.f : -1.f, corner & 4 ? 1.f : -1.f, 1.f);
+		if (clip.getZ() + clip.getW() <= 0.f)
+		{
+			numBehind += 1;
+			continue;
+		}
+
+		const RasterVertex v = dwgProject(renderer, clip, 0.f, 0.f, 0.f);
+		minX = fminf(minX, v.x);
+		minY = fminf(minY, v.y);
+		maxX = fmaxf(maxX, v.x);
+		maxY = fmaxf(maxY, v.y);
+	}
+
+	if (numBehind == 8)
+		return;
+
+	// crosses the near plane, the projection of the corners doesn't bound it
+	// the camera can be inside, back faces are drawn like in the OpenGL path (that doesn't cull)
+	if (numBehind > 0)
+	{
+		out.frontSign = 0.f;
+		minX = 0.f;
+		minY = 0.f;
+		maxX = (float)renderer.width;
+		maxY = (float)renderer.height;
+	}
+
+	out.minX = minX;
+	out.minY = minY;
+	out.maxX = maxX;
+	out.maxY = maxY;
+
+	if (!dwgTileBounds(renderer, minX, minY, maxX, maxY, out.minTileX, out.minTileY, out.maxTileX, out.maxTileY))
+	{
+		out.minTileX = 0;
+		out.maxTileX = -1;
+	}
+	else if (lod == DWG_SPHERE_IMPOSTOR)
+	{
+		out.inverseTransform = inverse(out.transform);
+	}
+}
+
+static void dwgRasterLine(SoftwareRenderer& renderer, const SoftwareLine& line, const RasterTile& tile)
+{
+	const float dx = line.x1 - line.x0;
+	const float dy = line.y1 - line.y0;
+	const int32_t numSamples = (int32_t)ceilf(fmaxf(fabsf(dx), fabsf(dy)));
+	const float invSamples = numSamples > 0 ? 1.f / numSamples : 0.f;
+
+	// samples near the tile, the same samples in every tile the line passes (no gaps or doubles at the tile edges)
+	float tMin = 0.f;
+	float tMax = 1.f;
+	const float bounds[2][2] = { { (float)tile.x0 - 1.f, (float)tile.x1 + 1.f }, { (float)tile.y0 - 1.f, (float)tile.y1 + 1.f } };
+	const float starts[2] = { line.x0, line.y0 };
+	const float deltas[2] = { dx, dy };
+
+	for (int32_t axis = 0; axis < 2; ++axis)
+	{
+		if (deltas[axis] == 0.f)
+		{
+			if (starts[axis] < bounds[axis][0] || starts[axis] > bounds[axis][1])
+				return;
+			continue;
+		}
+
+		float t0 = (bounds[axis][0] - starts[axis]) / deltas[axis];
+		float t1 = (bounds[axis][1] - starts[axis]) / deltas[axis];
+		if (t0 > t1)
+		{
+			const float t = t0;
+			t0 = t1;
+			t1 = t;
+		}
+
+		tMin = fmaxf(tMin, t0);
+		tMax = fminf(tMax, t1);
+	}
+
+	if (tMin > tMax)
+		return;
+
+	const int32_t first = (int32_t)floorf(tMin * numSamples);
+	const int32_t last = (int32_t)ceilf(tMax * numSamples);
+
+	for (int32_t i = first; i <= last && i <= numSamples; ++i)
+	{
+		const float t = i * invSamples;
+		const int32_t px = (int32_t)floorf(line.x0 + dx * t);
+		const int32_t py = (int32_t)floorf(line.y0 + dy * t);
+
+		if (px < tile.x0 || px >= tile.x1 || py < tile.y0 || py >= tile.y1)
+			continue;
+
+		const float z = line.z0 + (line.z1 - line.z0) * t;
+		float& depth = renderer.depth[(size_t)py * renderer.width + px];
+		if (!(z < depth))
+			continue;
+
+		depth = z;
+		dwgStoreColor(&renderer.color[((size_t)py * renderer.width + px) * 4], dwgPackColor(
+			line.color0[0] + (line.color1[0] - line.color0[0]) * t,
+			line.color0[1] + (line.color1[1] - line.color0[1]) * t,
+			line.color0[2] + (line.color1[2] - line.color0[2]) * t));
+	}
+}
+
+// edge functions, 4 pixels of a row at once with SSE, the triangle is already culled (see dwgTriangulateSphere)
+static void dwgRasterTriangle(SoftwareRenderer& renderer, const RasterVertex& v0, const RasterVertex& v1, const RasterVertex& v2,
+	const RasterTile& tile)
+{
+	// twice the signed area
+	float area = (v1.x - v0.x) * (v2.y - v0.y) - (v1.y - v0.y) * (v2.x - v0.x);
+	if (area == 0.f)
+		return;
+
+	const int32_t minX = (int32_t)fmaxf(floorf(fminf(fminf(v0.x, v1.x), v2.x)), (float)tile.x0);
+	const int32_t minY = (int32_t)fmaxf(floorf(fminf(fminf(v0.y, v1.y), v2.y)), (float)tile.y0);
+	const int32_t maxX = (int32_t)fminf(ceilf(fmaxf(fmaxf(v0.x, v1.x), v2.x)), (float)tile.x1);
+	const int32_t maxY = (int32_t)fminf(ceilf(fmaxf(fmaxf(v0.y, v1.y), v2.y)), (float)tile.y1);
+	if (minX >= maxX || minY >= maxY)
+		return;
+
+	// weights of the vertices are the edge functions of the opposite edges, all positive inside
+	const float sign = area > 0.f ? 1.f : -1.f;
+	const float invArea = 1.f / (area * sign);
+
+	const float e0x = -(v2.y - v1.y) * sign, e0y = (v2.x - v1.x) * sign;
+	const float e1x = -(v0.y - v2.y) * sign, e1y = (v0.x - v2.x) * sign;
+	const float e2x = -(v1.y - v0.y) * sign, e2y = (v1.x - v0.x) * sign;
+
+	for (int32_t py = minY; py < maxY; ++py)
+	{
+		const float fy = py + 0.5f;
+		const float fx = minX + 0.5f;
+
+		// weights at the first pixel of the row
+		const float w0 = e0x * (fx - v1.x) + e0y * (fy - v1.y);
+		const float w1 = e1x * (fx - v2.x) + e1y * (fy - v2.y);
+		const float w2 = e2x * (fx - v0.x) + e2y * (fy - v0.y);
+
+		float* depthRow = &renderer.depth[(size_t)py * renderer.width];
+		uint8_t* colorRow = &renderer.color[(size_t)py * renderer.width * 4];
+		int32_t px = minX;
+
+#if VECTORMATH_MODE_SSE
+		const __m128 lanes = _mm_set_ps(3.f, 2.f, 1.f, 0.f);
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 scale = _mm_set1_ps(255.f);
+		const __m128 half = _mm_set1_ps(0.5f);
+		const __m128i alpha = _mm_set1_epi32((int)0xff000000u);
+
+		__m128 w0x = _mm_add_ps(_mm_set1_ps(w0), _mm_mul_ps(lanes, _mm_set1_ps(e0x)));
+		__m128 w1x = _mm_add_ps(_mm_set1_ps(w1), _mm_mul_ps(lanes, _mm_set1_ps(e1x)));
+		__m128 w2x = _mm_add_ps(_mm_set1_ps(w2), _mm_mul_ps(lanes, _mm_set1_ps(e2x)));
+		const __m128 step0 = _mm_set1_ps(e0x * 4.f);
+		const __m128 step1 = _mm_set1_ps(e1x * 4.f);
+		const __m128 step2 = _mm_set1_ps(e2x * 4.f);
+		const __m128 invArea4 = _mm_set1_ps(invArea);
+
+		for (; px + 4 <= maxX; px += 4)
+		{
+			const __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(w0x, zero), _mm_cmpge_ps(w1x, zero)), _mm_cmpge_ps(w2x, zero));
+
+			if (_mm_movemask_ps(inside))
+			{
+				const __m128 b0 = _mm_mul_ps(w0x, invArea4);
+				const __m128 b1 = _mm_mul_ps(w1x, invArea4);
+				const __m128 b2 = _mm_mul_ps(w2x, invArea4);
+
+				const __m128 z = _mm_add_ps(_mm_add_ps(_mm_mul_ps(b0, _mm_set1_ps(v0.z)), _mm_mul_ps(b1, _mm_set1_ps(v1.z))), _mm_mul_ps(b2, _mm_set1_ps(v2.z)));
+				const __m128 depth = _mm_loadu_ps(depthRow + px);
+				const __m128 pass = _mm_and_ps(inside, _mm_cmplt_ps(z, depth));
+
+				if (_mm_movemask_ps(pass))
+				{
+					_mm_storeu_ps(depthRow + px, _mm_or_ps(_mm_and_ps(pass, z), _mm_andnot_ps(pass, depth)));
+
+					const __m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(b0, _mm_set1_ps(v0.r)), _mm_mul_ps(b1, _mm_set1_ps(v1.r))), _mm_mul_ps(b2, _mm_set1_ps(v2.r)));
+					const __m128 g = _mm_add_ps(_mm_add_ps(_mm_mul_ps(b0, _mm_set1_ps(v0.g)), _mm_mul_ps(b1, _mm_set1_ps(v1.g))), _mm_mul_ps(b2, _mm_set1_ps(v2.g)));
+					const __m128 b = _mm_add_ps(_mm_add_ps(_mm_mul_ps(b0, _mm_set1_ps(v0.b)), _mm_mul_ps(b1, _mm_set1_ps(v1.b))), _mm_mul_ps(b2, _mm_set1_ps(v2.b)));
+
+					// rgba8, r in the lowest byte, rounded like dwgPackColor (+ 0.5 and truncated) so the tail pixels match
+					const __m128i ri = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_min_ps(_mm_max_ps(r, zero), _mm_set1_ps(1.f)), scale), half));
+					const __m128i gi = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_min_ps(_mm_max_ps(g, zero), _mm_set1_ps(1.f)), scale), half));
+					const __m128i bi = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_min_ps(_mm_max_ps(b, zero), _mm_set1_ps(1.f)), scale), half));
+					const __m128i rgba = _mm_or_si128(_mm_or_si128(ri, _mm_slli_epi32(gi, 8)), _mm_or_si128(_mm_slli_epi32(bi, 16), alpha));
+
+					const __m128i passi = _mm_castps_si128(pass);
+					const __m128i old = _mm_loadu_si128((const __m128i*)(colorRow + px * 4));
+					_mm_storeu_si128((__m128i*)(colorRow + px * 4), _mm_or_si128(_mm_and_si128(passi, rgba), _mm_andnot_si128(passi, old)));
+				}
+			}
+
+			w0x = _mm_add_ps(w0x, step0);
+			w1x = _mm_add_ps(w1x, step1);
+			w2x = _mm_add_ps(w2x, step2);
+		}
+#endif
+
+		// tail of the row (whole row without SSE)
+		for (; px < maxX; ++px)
+		{
+			const float ox = (float)(px - minX);
+			const float a0 = w0 + e0x * ox;
+			const float a1 = w1 + e1x * ox;
+			const float a2 = w2 + e2x * ox;
+			if (a0 < 0.f || a1 < 0.f || a2 < 0.f)
+				continue;
+
+			const float b0 = a0 * invArea;
+			const float b1 = a1 * invArea;
+			const float b2 = a2 * invArea;
+
+			const float z = b0 * v0.z + b1 * v1.z + b2 * v2.z;
+			if (!(z < depthRow[px]))
+				continue;
+
+			depthRow[px] = z;
+			dwgStoreColor(colorRow + px * 4, dwgPackColor(
+				b0 * v0.r + b1 * v1.r + b2 * v2.r,
+				b0 * v0.g + b1 * v1.g + b2 * v2.g,
+				b0 * v0.b + b1 * v1.b + b2 * v2.b));
+		}
+	}
+}
+
+// the most triangles dwgTriangulateSphere writes, the near plane clipping can split every triangle to two
+static int32_t dwgMaxSphereTriangles(const SoftwareRenderer& renderer, const SoftwareSphere& sphere)
+{
+	if (sphere.lod == DWG_SPHERE_IMPOSTOR || sphere.minTileX > sphere.maxTileX)
+		return 0;
+
+	const int32_t numTriangles = renderer.meshLods[sphere.lod].numIndices / 3;
+	return sphere.frontSign == 0.f ? numTriangles * 2 : numTriangles;
+}
+
+// transforms, clips and culls the mesh once, the tiles only rasterize the triangles at sphere.firstTriangle
+static void dwgTriangulateSphere(SoftwareRenderer& renderer, SoftwareSphere& sphere, std::vector<Vector4>& clipVertices)
+{
+	const DebugSphereLod& mesh = renderer.meshLods[sphere.lod];
+	clipVertices.resize(mesh.numVertices);
+
+	for (int32_t i = 0; i < mesh.numVertices; ++i)
+	{
+		const DebugVertex& v = renderer.meshVertices[mesh.firstVertex + i];
+		clipVertices[i] = sphere.transform * Vector4(v.x, v.y, v.z, 1.f);
+	}
+
+	const uint16_t* indices = renderer.meshIndices.data() + mesh.firstIndex;
+	RasterVertex* triangles = renderer.sphereTriangles.data() + (size_t)sphere.firstTriangle * 3;
+
+	for (int32_t t = 0; t + 2 < mesh.numIndices; t += 3)
+	{
+		const int32_t i[3] = { indices[t], indices[t + 1], indices[t + 2] };
+		const Vector4 clip[3] = { clipVertices[i[0] - mesh.firstVertex], clipVertices[i[1] - mesh.firstVertex], clipVertices[i[2] - mesh.firstVertex] };
+
+		RasterVertex v[4];
+		int32_t numClipped = 0;
+
+		// clip by the near plane (z > -w), a triangle becomes a quad at most
+		for (int32_t k = 0; k < 3; ++k)
+		{
+			const int32_t n = (k + 1) % 3;
+			const float dk = clip[k].getZ() + clip[k].getW();
+			const float dn = clip[n].getZ() + clip[n].getW();
+			const DebugVertex& mk = renderer.meshVertices[i[k]];
+			const DebugVertex& mn = renderer.meshVertices[i[n]];
+
+			if (dk > 0.f)
+			{
+				v[numClipped++] = dwgProject(renderer, clip[k], mk.r * sphere.color[0], mk.g * sphere.color[1], mk.b * sphere.color[2]);
+			}
+
+			if ((dk > 0.f) != (dn > 0.f))
+			{
+				const float s = dk / (dk - dn);
+				v[numClipped++] = dwgProject(renderer, lerp(s, clip[k], clip[n]),
+					(mk.r + (mn.r - mk.r) * s) * sphere.color[0],
+					(mk.g + (mn.g - mk.g) * s) * sphere.color[1],
+					(mk.b + (mn.b - mk.b) * s) * sphere.color[2]);
+			}
+		}
+
+		for (int32_t k = 2; k < numClipped; ++k)
+		{
+			// the sphere mesh is CW from outside, in the y down screen space that's a positive area (see SoftwareSphere::frontSign)
+			const float area = (v[k - 1].x - v[0].x) * (v[k].y - v[0].y) - (v[k - 1].y - v[0].y) * (v[k].x - v[0].x);
+			if (area == 0.f || area * sphere.frontSign < 0.f)
+				continue;
+
+			RasterVertex* triangle = triangles + (size_t)sphere.numTriangles * 3;
+			triangle[0] = v[0];
+			triangle[1] = v[k - 1];
+			triangle[2] = v[k];
+			sphere.numTriangles += 1;
+		}
+	}
+}
+
+static void dwgRasterSphere(SoftwareRenderer& renderer, const SoftwareSphere& sphere, const RasterTile& tile)
+{
+	const RasterVertex* triangles = renderer.sphereTriangles.data() + (size_t)sphere.firstTriangle * 3;
+
+	for (int32_t t = 0; t < sphere.numTriangles; ++t)
+	{
+		dwgRasterTriangle(renderer, triangles[t * 3], triangles[t * 3 + 1], triangles[t * 3 + 2], tile);
+	}
+}
+
+// the same as the impostor fragment shader, the ray from the near to the far plane in the local space of the unit sphere
+static void dwgRasterImpostor(SoftwareRenderer& renderer, const SoftwareSphere& sphere, const RasterTile& tile)
+{
+	const int32_t minX = (int32_t)fmaxf(floorf(sphere.minX), (float)tile.x0);
+	const int32_t minY = (int32_t)fmaxf(floorf(sphere.minY), (float)tile.y0);
+	const int32_t maxX = (int32_t)fminf(ceilf(sphere.maxX), (float)tile.x1);
+	const int32_t maxY = (int32_t)fminf(ceilf(sphere.maxY), (float)tile.y1);
+
+	// points of the ray are linear in the ndc x (before the division by w)
+	const Matrix4& m = sphere.inverseTransform;
+	const Vector4 stepX = m.getCol0() * (2.f / renderer.width);
+
+	for (int32_t py = minY; py < maxY; ++py)
+	{
+		const float ndcY = 1.f - (py + 0.5f) * 2.f / renderer.height;
+		const float ndcX = (minX + 0.5f) * 2.f / renderer.width - 1.f;
+		Vector4 nearPoint = m * Vector4(ndcX, ndcY, -1.f, 1.f);
+		Vector4 farPoint = m * Vector4(ndcX, ndcY, 1.f, 1.f);
+
+		for (int32_t px = minX; px < maxX; ++px, nearPoint += stepX, farPoint += stepX)
+		{
+			const Vector3 origin = nearPoint.getXYZ() / nearPoint.getW();
+			const Vector3 direction = farPoint.getXYZ() / farPoint.getW() - origin;
+
+			const float a = dot(direction, direction);
+			const float b = dot(origin, direction);
+			const float c = dot(origin, origin) - 1.f;
+			const float discriminant = b * b - a * c;
+			if (discriminant < 0.f)
+				continue;
+
+			const float t = (-b - sqrtf(discriminant)) / a;
+			const Vector3 normal = origin + direction * t;
+			const Vector4 clip = sphere.transform * Vector4(normal, 1.f);
+			const float z = clip.getZ() / clip.getW() * 0.5f + 0.5f;
+
+			float& depth = renderer.depth[(size_t)py * renderer.width + px];
+			if (t < 0.f || !(z < depth))
+				continue;
+
+			depth = z;
+			const float intensity = 0.2f + 0.8f * fminf(fmaxf(normal.getX() + normal.getY() + normal.getZ(), 0.f), 1.f);
+			dwgStoreColor(&renderer.color[((size_t)py * renderer.width + px) * 4],
+				dwgPackColor(sphere.color[0] * intensity, sphere.color[1] * intensity, sphere.color[2] * intensity));
+		}
+	}
+}
+
+void dwgSoftwareSetSphereMesh(SoftwareRenderer& renderer, const DebugVertex* vertices, int32_t numVertices, const uint16_t* indices, int32_t numIndices,
+	const DebugSphereLod* lods, int32_t numLods)
+{
+	renderer.meshVertices.assign(vertices, vertices + numVertices);
+	renderer.meshIndices.assign(indices, indices + numIndices);
+
+	for (int32_t lod = 0; lod <= DWG_SPHERE_IMPOSTOR && lod < numLods; ++lod)
+	{
+		renderer.meshLods[lod] = lods[lod];
+	}
+}
+
+void dwgSoftwareBeginFrame(SoftwareRenderer& renderer, int32_t width, int32_t height, const Matrix4& mvp)
+{
+	renderer.width = width;
+	renderer.height = height;
+	renderer.mvp = mvp;
+
+	// 4 pixels of slack, the last SSE load of a row can read past the end
+	renderer.color.resize(((size_t)width * height + 4) * 4);
+	renderer.depth.resize((size_t)width * height + 4);
+
+	renderer.lineBatches.clear();
+	renderer.sphereBatches.clear();
+}
+
+void dwgSoftwareAddLines(SoftwareRenderer& renderer, const DebugVertex* vertices, int32_t numVertices)
+{
+	if (numVertices >= 2)
+		renderer.lineBatches.push_back({ vertices, numVertices / 2, 0 });
+}
+
+void dwgSoftwareAddSpheres(SoftwareRenderer& renderer, const DebugSphere* spheres, int32_t numSpheres, int32_t lod)
+{
+	if (numSpheres > 0)
+		renderer.sphereBatches.push_back({ spheres, numSpheres, lod });
+}
+
+// index of every primitive, so the setup can run in parallel over all batches
+static void dwgFlattenBatches(const std::vector<SoftwareBatch>& batches, std::vector<const void*>& items, size_t itemSize)
+{
+	items.clear();
+	for (const SoftwareBatch& batch : batches)
+	{
+		for (int32_t i = 0; i < batch.count; ++i)
+		{
+			items.push_back((const uint8_t*)batch.data + itemSize * i);
+		}
+	}
+}
+
+void dwgSoftwareEndFrame(SoftwareRenderer& renderer)
+{
+	const std::chrono::steady_clock::time_point setupStart = std::chrono::steady_clock::now();
+
+	// transform and clip
+	std::vector<const void*> lineItems;
+	dwgFlattenBatches(renderer.lineBatches, lineItems, sizeof(DebugVertex) * 2);
+	renderer.lines.resize(lineItems.size());
+	dwgParallelFor((int32_t)lineItems.size(), 1024, [&](int32_t begin, int32_t end)
+	{
+		for (int32_t i = begin; i < end; ++i)
+		{
+			const DebugVertex* vertices = (const DebugVertex*)lineItems[i];
+			dwgSetupLine(renderer, vertices[0], vertices[1], renderer.lines[i]);
+		}
+	});
+
+	// there are only a few sphere batches (one per LOD)
+	renderer.spheres.clear();
+	for (const SoftwareBatch& batch : renderer.sphereBatches)
+	{
+		const DebugSphere* spheres = (const DebugSphere*)batch.data;
+		const size_t offset = renderer.spheres.size();
+
+		renderer.spheres.resize(offset + batch.count);
+		dwgParallelFor(batch.count, 256, [&](int32_t begin, int32_t end)
+		{
+			for (int32_t i = begin; i < end; ++i)
+			{
+				dwgSetupSphere(renderer, spheres[i], batch.lod, renderer.spheres[offset + i]);
+			}
+		});
+	}
+
+	// the sphere meshes are projected once, every sphere gets room for its most triangles
+	int64_t numSphereTriangles = 0;
+	for (SoftwareSphere& sphere : renderer.spheres)
+	{
+		sphere.firstTriangle = (int32_t)numSphereTriangles;
+		numSphereTriangles += dwgMaxSphereTriangles(renderer, sphere);
+	}
+	renderer.sphereTriangles.resize((size_t)numSphereTriangles * 3);
+
+	dwgParallelFor((int32_t)renderer.spheres.size(), 64, [&](int32_t begin, int32_t end)
+	{
+		std::vector<Vector4> clipVertices;
+
+		for (int32_t i = begin; i < end; ++i)
+		{
+			if (dwgMaxSphereTriangles(renderer, renderer.spheres[i]) > 0)
+				dwgTriangulateSphere(renderer, renderer.spheres[i], clipVertices);
+		}
+	});
+
+	renderer.numTriangles = 0;
+	for (const SoftwareSphere& sphere : renderer.spheres)
+	{
+		renderer.numTriangles += sphere.numTriangles;
+	}
+
+	// bin to tiles, in the order of the primitives
+	renderer.numTilesX = (renderer.width + DWG_SOFTWARE_TILE_SIZE - 1) / DWG_SOFTWARE_TILE_SIZE;
+	renderer.numTilesY = (renderer.height + DWG_SOFTWARE_TILE_SIZE - 1) / DWG_SOFTWARE_TILE_SIZE;
+	const int32_t numTiles = renderer.numTilesX * renderer.numTilesY;
+
+	renderer.tileLines.resize(numTiles);
+	renderer.tileSpheres.resize(numTiles);
+	for (int32_t tile = 0; tile < numTiles; ++tile)
+	{
+		renderer.tileLines[tile].clear();
+		renderer.tileSpheres[tile].clear();
+	}
+
+	for (int32_t i = 0; i < (int32_t)renderer.lines.size(); ++i)
+	{
+		const SoftwareLine& line = renderer.lines[i];
+		for (int32_t ty = line.minTileY; ty <= line.maxTileY && line.minTileX <= line.maxTileX; ++ty)
+		{
+			for (int32_t tx = line.minTileX; tx <= line.maxTileX; ++tx)
+			{
+				renderer.tileLines[ty * renderer.numTilesX + tx].push_back(i);
+			}
+		}
+	}
+
+	for (int32_t i = 0; i < (int32_t)renderer.spheres.size(); ++i)
+	{
+		const SoftwareSphere& sphere = renderer.spheres[i];
+		for (int32_t ty = sphere.minTileY; ty <= sphere.maxTileY && sphere.minTileX <= sphere.maxTileX; ++ty)
+		{
+			for (int32_t tx = sphere.minTileX; tx <= sphere.maxTileX; ++tx)
+			{
+				renderer.tileSpheres[ty * renderer.numTilesX + tx].push_back(i);
+			}
+		}
+	}
+
+	renderer.setupTime = dwgMillisecondsSince(setupStart);
+	const std::chrono::steady_clock::time_point rasterStart = std::chrono::steady_clock::now();
+
+	// every tile clears and draws its own pixels
+	dwgParallelFor(numTiles, 1, [&](int32_t begin, int32_t end)
+	{
+		for (int32_t index = begin; index < end; ++index)
+		{
+			RasterTile tile;
+			tile.x0 = (index % renderer.numTilesX) * DWG_SOFTWARE_TILE_SIZE;
+			tile.y0 = (index / renderer.numTilesX) * DWG_SOFTWARE_TILE_SIZE;
+			tile.x1 = tile.x0 + DWG_SOFTWARE_TILE_SIZE < renderer.width ? tile.x0 + DWG_SOFTWARE_TILE_SIZE : renderer.width;
+			tile.y1 = tile.y0 + DWG_SOFTWARE_TILE_SIZE < renderer.height ? tile.y0 + DWG_SOFTWARE_TILE_SIZE : renderer.height;
+
+			// black, like glClear
+			for (int32_t y = tile.y0; y < tile.y1; ++y)
+			{
+				const size_t row = (size_t)y * renderer.width;
+				for (int32_t x = tile.x0; x < tile.x1; ++x)
+				{
+					renderer.depth[row + x] = 1.f;
+					dwgStoreColor(&renderer.color[(row + x) * 4], 0xff000000u);
+				}
+			}
+
+			for (int32_t i : renderer.tileLines[index])
+			{
+				dwgRasterLine(renderer, renderer.lines[i], tile);
+			}
+
+			for (int32_t i : renderer.tileSpheres[index])
+			{
+				const SoftwareSphere& sphere = renderer.spheres[i];
+				if (sphere.lod == DWG_SPHERE_IMPOSTOR)
+					dwgRasterImpostor(renderer, sphere, tile);
+				else
+					dwgRasterSphere(renderer, sphere, tile);
+			}
+		}
+	});
+
+	renderer.rasterTime = dwgMillisecondsSince(rasterStart);
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include "vectormath.hpp"
+#include "dwgDebugPrimitives.h"
+
+// CPU rasterizer of the debug renderer, it needs no GPU nor OpenGL (DWG_APP_SOFTWARE)
+// the screen is split to tiles, primitives are binned to the tiles they overlap and every tile is one task of dwgParallelFor
+// a tile draws its primitives in the order they were added, so the image is the same with any number of threads
+//
+//	dwgSoftwareBeginFrame(renderer, width, height, mvp);
+//	dwgSoftwareAddLines(renderer, vertices, numVertices);	// any number of batches
+//	dwgSoftwareAddSpheres(renderer, spheres, numSpheres, lod);	// one batch per LOD (or DWG_SPHERE_IMPOSTOR)
+//	dwgSoftwareEndFrame(renderer);	// renderer.color has the image
+//
+// the same conventions as the OpenGL path: lines first, then spheres, depth test less, colors interpolated
+// in screen space (no perspective correction, it makes no visible difference for the small debug triangles)
+
+#define DWG_SOFTWARE_TILE_SIZE 64
+
+// vertex after the projection, x and y in pixels (y goes down), z is the depth 0..1
+struct RasterVertex
+{
+	float x, y, z;
+	float r, g, b;
+};
+
+// clipped line in screen space
+struct SoftwareLine
+{
+	float x0, y0, z0;
+	float x1, y1, z1;
+	float color0[3];
+	float color1[3];
+	int32_t minTileX, minTileY, maxTileX, maxTileY;	// minTileX > maxTileX when the line is not visible
+};
+
+struct SoftwareSphere
+{
+	Matrix4 transform;	// mvp * world
+	Matrix4 inverseTransform;	// impostors only, clip space to the local space of the unit sphere
+	int32_t lod;	// DWG_SPHERE_IMPOSTOR = the ray through every pixel is intersected with the unit sphere
+	float minX, minY, maxX, maxY;	// pixels
+	float color[3];
+	float frontSign;	// -1 for negative scale (front faces have the other winding), 0 = no culling (it crosses the near plane)
+	int32_t minTileX, minTileY, maxTileX, maxTileY;
+	int32_t firstTriangle;	// mesh only, projected once and shared by all tiles, see SoftwareRenderer::sphereTriangles
+	int32_t numTriangles;
+};
+
+struct SoftwareBatch
+{
+	const void* data;
+	int32_t count;
+	int32_t lod;	// spheres only
+};
+
+struct SoftwareRenderer
+{
+	int32_t width = 0;
+	int32_t height = 0;
+	std::vector<uint8_t> color;	// rgba8, rows from top to bottom
+	std::vector<float> depth;	// 0..1 like the GL depth buffer
+
+	// sphere meshes, see dwgSoftwareSetSphereMesh
+	std::vector<DebugVertex> meshVertices;
+	std::vector<uint16_t> meshIndices;
+	DebugSphereLod meshLods[DWG_SPHERE_LODS + 1] = {};	// + the impostor quad (not used, impostors are ray cast)
+
+	// the frame
+	Matrix4 mvp;
+	std::vector<SoftwareBatch> lineBatches;
+	std::vector<SoftwareBatch> sphereBatches;
+
+	std::vector<SoftwareLine> lines;
+	std::vector<SoftwareSphere> spheres;
+
+	int32_t numTilesX = 0;
+	int32_t numTilesY = 0;
+	std::vector<std::vector<int32_t>> tileLines;	// indices to lines overlapping the tile
+	std::vector<std::vector<int32_t>> tileSpheres;
+	std::vector<RasterVertex> sphereTriangles;	// 3 vertices per triangle of the visible sphere meshes, clipped and culled
+
+	// stats of the last frame
+	int64_t numTriangles = 0;	// rasterized (after clipping and culling), impostors are not counted
+	float setupTime = 0.f;	// ms, transforms and binning
+	float rasterTime = 0.f;	// ms
+};
+
+// copies the triangle meshes of the sphere LODs (unit spheres, CW triangles seen from outside)
+void dwgSoftwareSetSphereMesh(SoftwareRenderer& renderer, const DebugVertex* vertices, int32_t numVertices, const uint16_t* indices, int32_t numIndices,
+	const DebugSphereLod* lods, int32_t numLods);
+
+// resizes the buffers and starts a frame
+void dwgSoftwareBeginFrame(SoftwareRenderer& renderer, int32_t width, int32_t height, const Matrix4& mvp);
+
+// vertices are pairs of line points, data are read by dwgSoftwareEndFrame, they have to stay valid until then
+void dwgSoftwareAddLines(SoftwareRenderer& renderer, const DebugVertex* vertices, int32_t numVertices);
+void dwgSoftwareAddSpheres(SoftwareRenderer& renderer, const DebugSphere* spheres, int32_t numSpheres, int32_t lod);
+
+// clears the buffers and draws the frame
+void dwgSoftwareEndFrame(SoftwareRenderer& renderer);